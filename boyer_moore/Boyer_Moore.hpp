@@ -1,23 +1,325 @@
+#pragma once
+
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <map>
 #include <string>
 #include <tuple>
 #include <type_traits>
 #include <vector>
 
+// 字节文本的SIMD候选过滤. 编译期选择: AVX2(32字节) > SSE2(16字节) > 标量
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define WZJ_BM_SIMD_WIDTH 32
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WZJ_BM_SIMD_WIDTH 16
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace wzj {
+namespace bm_detail {
+// 迭代器是否指向连续的单字节内存. 只有这种情况可以用SIMD/memchr
+template <typename _It>
+struct is_contiguous_byte_iter : std::false_type {};
+template <typename _T>
+struct is_contiguous_byte_iter<_T*> : std::integral_constant<bool, sizeof(_T) == 1> {};
+template <>
+struct is_contiguous_byte_iter<std::string::iterator> : std::true_type {};
+template <>
+struct is_contiguous_byte_iter<std::string::const_iterator> : std::true_type {};
+template <>
+struct is_contiguous_byte_iter<std::vector<char>::iterator> : std::true_type {};
+template <>
+struct is_contiguous_byte_iter<std::vector<char>::const_iterator> : std::true_type {};
+template <>
+struct is_contiguous_byte_iter<std::vector<unsigned char>::iterator> : std::true_type {};
+template <>
+struct is_contiguous_byte_iter<std::vector<unsigned char>::const_iterator> : std::true_type {};
+
+// 最低的1所在的位置, 要求mask != 0
+inline int lowest_bit(unsigned mask) {
+#ifdef _MSC_VER
+  unsigned long idx;
+  _BitScanForward(&idx, mask);
+  return static_cast<int>(idx);
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+inline int lowest_bit(std::uint64_t mask) {
+  auto lo = static_cast<unsigned>(mask);
+  return lo ? lowest_bit(lo) : 32 + lowest_bit(static_cast<unsigned>(mask >> 32));
+}
+
+// 在s[0, n-m]中找第一个位置i, 满足s[i]==head, s[i+m-1]==tail并且verify(i)为真. 找不到返回n.
+// 要求m>=2. 每次比较WZJ_BM_SIMD_WIDTH个位置的首尾字节, 只对候选位置调用verify
+template <typename _Verify>
+std::size_t find_head_tail(const unsigned char* s, std::size_t n, std::size_t m,
+                           unsigned char head, unsigned char tail, _Verify verify) {
+  std::size_t i = 0;
+  if (n < m) return n;
+#if WZJ_BM_SIMD_WIDTH == 32
+  const __m256i vh = _mm256_set1_epi8(static_cast<char>(head));
+  const __m256i vt = _mm256_set1_epi8(static_cast<char>(tail));
+  for (; i + m - 1 + 32 <= n; i += 32) {
+    __m256i bh = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+    __m256i bt = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i + m - 1));
+    auto mask = static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(vh, bh), _mm256_cmpeq_epi8(vt, bt))));
+    while (mask) {
+      auto k = i + lowest_bit(mask);
+      if (verify(k)) return k;
+      mask &= mask - 1;
+    }
+  }
+#elif WZJ_BM_SIMD_WIDTH == 16
+  const __m128i vh = _mm_set1_epi8(static_cast<char>(head));
+  const __m128i vt = _mm_set1_epi8(static_cast<char>(tail));
+  for (; i + m - 1 + 16 <= n; i += 16) {
+    __m128i bh = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+    __m128i bt = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + m - 1));
+    auto mask = static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(vh, bh), _mm_cmpeq_epi8(vt, bt))));
+    while (mask) {
+      auto k = i + lowest_bit(mask);
+      if (verify(k)) return k;
+      mask &= mask - 1;
+    }
+  }
+#endif
+  // 剩余不足一个向量的部分
+  for (; i + m <= n; ++i)
+    if (s[i] == head && s[i + m - 1] == tail && verify(i)) return i;
+  return n;
+}
+
+// 在s[0, n)中找模式pat[0, m)第一次出现的位置, 找不到返回n. 要求m>=1.
+// m==1时用memchr, 否则用find_head_tail过滤首尾字节, 再逐个比较中间的字节
+template <typename _PatIt>
+std::size_t find_bytes(const unsigned char* s, std::size_t n, _PatIt pat, std::size_t m) {
+  if (n < m) return n;
+  auto head = static_cast<unsigned char>(pat[0]);
+  if (m == 1) {
+    auto p = static_cast<const unsigned char*>(std::memchr(s, head, n));
+    return p ? static_cast<std::size_t>(p - s) : n;
+  }
+  auto tail = static_cast<unsigned char>(pat[m - 1]);
+  return find_head_tail(s, n, m, head, tail, [&](std::size_t i) {
+    for (std::size_t j = 1; j + 1 < m; ++j)
+      if (s[i + j] != static_cast<unsigned char>(pat[j])) return false;
+    return true;
+  });
+}
+
+// 判断字串[pos, end)是否是前缀
+template <typename _It, typename _Diff>
+bool is_prefix(_It pat, _Diff pat_len, _Diff pos) {
+  _Diff suffixlen = pat_len - pos;
+  for (_Diff i = 0; i < suffixlen; ++i)
+    if (pat[i] != pat[pos + i]) return false;
+  return true;
+}
+// 返回[0, pos]和[0, pat_len)的共同后缀长度+1
+template <typename _It, typename _Diff>
+_Diff suffix_length(_It pat, _Diff pat_len, _Diff pos) {
+  _Diff i = 0;
+  for (; pat[pos - i] == pat[pat_len - 1 - i] && i < pos; ++i)
+    ;
+  return i;
+}
+
+// GOOD-SUFFIX RULE的表格. good[0, pat_len)必须已经分配好
+template <typename _It, typename _Diff, typename _Table>
+void make_good_suffix(_It pat, _Diff pat_len, _Table& good) {
+  if (pat_len == 0) return;
+  // loop 1, part match. 例如: lsp000alsp, 后缀alsp没匹配项, 但有部分匹配,
+  // ([a]lsp)000alsp这样的形式
+  _Diff last_prefix_index = 1;
+  for (_Diff i = pat_len - 1; i >= 0; --i) {
+    if (is_prefix(pat, pat_len, i + 1)) last_prefix_index = i + 1;
+    good[i] = last_prefix_index + (pat_len - 1 - i);
+  }
+  // loop 2. full match. 例如: 00alspxalsp中, 后缀alsp匹配00(alsp)xalsp
+  for (_Diff i = 0; i < pat_len - 1; ++i) {
+    auto slen = suffix_length(pat, pat_len, i);
+    auto pos = pat_len - 1 - slen;
+    if (pat[i - slen] != pat[pos]) good[pos] = pat_len - 1 - i + slen;
+  }
+}
+}  // namespace bm_detail
 
+// BAD-CHARACTER RULE的表格策略. 接口:
+//   void build(_PatIt pat, _Diff pat_len);  // 预处理模式
+//   _Diff operator()(ch) const;             // ch在模式中最右出现的位置到模式末尾的距离, 没出现返回pat_len
+//
+// 单字节元素: 256项的稠密表
+template <typename _Diff>
+class bm_dense_bad_char {
+ public:
+  template <typename _PatIt>
+  void build(_PatIt pat, _Diff pat_len) {
+    table_.fill(pat_len);
+    for (_Diff i = 0; i < pat_len; ++i) table_[to_index(pat[i])] = pat_len - 1 - i;
+  }
+  template <typename _Ch>
+  _Diff operator()(_Ch ch) const {
+    return table_[to_index(ch)];
+  }
+
+ private:
+  template <typename _Ch>
+  static std::size_t to_index(_Ch ch) {
+    static_assert(sizeof(_Ch) == 1, "bm_dense_bad_char only supports byte elements");
+    return static_cast<unsigned char>(ch);
+  }
+
+  std::array<_Diff, 256> table_;
+};
+
+// 宽字符(char16_t, char32_t, uint32_t的token等): 开放寻址的扁平哈希表, 只保存模式中出现的字符.
+// 元素必须能转换成整数
+template <typename _Value, typename _Diff>
+class bm_hash_bad_char {
+ public:
+  template <typename _PatIt>
+  void build(_PatIt pat, _Diff pat_len) {
+    default_ = pat_len;
+    // 负载因子不超过1/2
+    std::size_t cap = 2;
+    while (cap < 2 * static_cast<std::size_t>(pat_len)) cap <<= 1;
+    mask_ = cap - 1;
+    slots_.assign(cap, slot{_Value(), -1});
+    for (_Diff i = 0; i < pat_len; ++i) {
+      auto k = find(pat[i]);
+      slots_[k].key = pat[i];
+      slots_[k].shift = pat_len - 1 - i;
+    }
+  }
+  _Diff operator()(const _Value& ch) const {
+    auto& e = slots_[find(ch)];
+    return e.shift < 0 ? default_ : e.shift;
+  }
+
+ private:
+  struct slot {
+    _Value key;
+    _Diff shift;  // -1表示空
+  };
+
+  // 返回ch所在的位置, 或者应该插入的空位置
+  std::size_t find(const _Value& ch) const {
+    // Fibonacci哈希, 取高位
+    auto h = static_cast<std::uint64_t>(ch) * 0x9E3779B97F4A7C15ull;
+    auto k = static_cast<std::size_t>(h >> 32) & mask_;
+    while (slots_[k].shift >= 0 && !(slots_[k].key == ch)) k = (k + 1) & mask_;
+    return k;
+  }
+
+  std::vector<slot> slots_;
+  std::size_t mask_ = 0;
+  _Diff default_ = 0;
+};
+
+// 根据模式元素的大小选择默认策略
 template <typename _It>
-class boyer_moore {
+struct bm_default_bad_char {
+  using _value_type = typename std::iterator_traits<_It>::value_type;
+  using _diff_type = typename std::iterator_traits<_It>::difference_type;
+  using type = typename std::conditional<sizeof(_value_type) == 1, bm_dense_bad_char<_diff_type>,
+                                         bm_hash_bad_char<_value_type, _diff_type>>::type;
+};
+
+// 搜索统计策略. 接口:
+//   static constexpr bool enabled;              // false时不统计, 所有调用都是空函数
+//   void on_attempt();                          // 对齐一个窗口并开始比较
+//   void on_compare(std::size_t n);             // 比较了n个字符
+//   void on_match();                            // 找到一个匹配
+//   void on_shift(std::ptrdiff_t d, bool good); // 窗口移动d, good表示移动距离来自good_char_
+//
+// 默认策略: 不统计, 没有任何开销
+struct bm_no_stats {
+  static constexpr bool enabled = false;
+  void on_attempt() {}
+  void on_compare(std::size_t) {}
+  void on_match() {}
+  void on_shift(std::ptrdiff_t, bool) {}
+};
+
+// 统计比较次数和移动距离的分布. 移动距离按2的幂分桶: 第k个桶是[2^k, 2^(k+1)).
+// bad_char和good_char给出相同距离时算作bad_char.
+// 统计保存在searcher中, 带统计的searcher不能在多个线程中同时使用
+struct bm_search_stats {
+  static constexpr bool enabled = true;
+  static constexpr std::size_t buckets_ = 64;
+
+  std::uint64_t attempts = 0;     // 对齐的窗口数
+  std::uint64_t comparisons = 0;  // 字符比较次数
+  std::uint64_t matches = 0;
+  std::array<std::uint64_t, buckets_> bad_char_shifts{};   // 由bad_char_决定的移动
+  std::array<std::uint64_t, buckets_> good_char_shifts{};  // 由good_char_决定的移动
+  // 每次on_shift之后调用, 可以用来把统计上报到别处
+  std::function<void(const bm_search_stats&)> callback;
+
+  void on_attempt() { ++attempts; }
+  void on_compare(std::size_t n) { comparisons += n; }
+  void on_match() { ++matches; }
+  void on_shift(std::ptrdiff_t d, bool good) {
+    std::size_t k = 0;
+    while (k + 1 < buckets_ && (std::ptrdiff_t(2) << k) <= d) ++k;
+    ++(good ? good_char_shifts : bad_char_shifts)[k];
+    if (callback) callback(*this);
+  }
+  // 移动次数
+  std::uint64_t shifts() const {
+    std::uint64_t n = 0;
+    for (std::size_t k = 0; k < buckets_; ++k) n += bad_char_shifts[k] + good_char_shifts[k];
+    return n;
+  }
+  // 清空计数, 保留callback
+  void reset() {
+    attempts = comparisons = matches = 0;
+    bad_char_shifts.fill(0);
+    good_char_shifts.fill(0);
+  }
+};
+
+namespace bm_detail {
+// 保存统计策略. operator()是const, 统计需要在其中更新.
+// 空的策略(bm_no_stats)作为基类, 空基类优化后不占空间
+template <typename _Stats, bool = std::is_empty<_Stats>::value>
+struct stats_holder : private _Stats {
+  // 空类没有可以修改的状态, const_cast不会修改const对象
+  _Stats& _stats() const { return const_cast<stats_holder&>(*this); }
+};
+template <typename _Stats>
+struct stats_holder<_Stats, false> {
+  _Stats& _stats() const { return stats_; }
+  mutable _Stats stats_;
+};
+}  // namespace bm_detail
+
+// _Stats是统计策略, 见bm_no_stats. 开启统计时不使用SIMD/memchr, 总是走跳跃循环
+template <typename _It, typename _BadChar = typename bm_default_bad_char<_It>::type,
+          typename _Stats = bm_no_stats>
+class boyer_moore : private bm_detail::stats_holder<_Stats> {
  public:
   using _diff_type = typename std::iterator_traits<_It>::difference_type;
+  using _value_type = typename std::iterator_traits<_It>::value_type;
+  // 字节文本上, 不超过该长度的模式使用SIMD首尾字节过滤, 而不是跳跃
+  static constexpr _diff_type simd_max_pattern_ = 32;
 
  public:
-  boyer_moore(_It first, _It last) : st_(first), en_(last), good_char_(last - first) {
+  boyer_moore(_It first, _It last) : good_char_(last - first), st_(first), en_(last) {
     make_delta1(first, last - first);
     make_delta2(first, last - first);
   }
@@ -27,10 +329,95 @@ class boyer_moore {
                                              _TargetIt last) const {
     auto pat_len = en_ - st_;
     if (pat_len == 0) return std::make_pair(first, first);
+    // 只有模式和文本都是单字节时, 才能用SIMD/memchr
+    return _search(first, last,
+                   std::integral_constant<bool, sizeof(_value_type) == 1 && !_Stats::enabled &&
+                                                    bm_detail::is_contiguous_byte_iter<_TargetIt>::value>());
+  }
+
+  // 模式长度
+  _diff_type size() const { return en_ - st_; }
+
+  // 累计的搜索统计. 只有_Stats = bm_search_stats等统计策略时有意义
+  const _Stats& stats() const { return this->_stats(); }
+  _Stats& stats() { return this->_stats(); }
 
+  // 返回所有匹配区间. overlap==false时, 找到一个匹配后从它的末尾继续, 匹配之间不重叠
+  template <typename _TargetIt>
+  std::vector<std::pair<_TargetIt, _TargetIt>> find_all(_TargetIt first, _TargetIt last,
+                                                        bool overlap = true) const {
+    std::vector<std::pair<_TargetIt, _TargetIt>> ans;
+    for_each_match(
+        first, last, [&ans](_TargetIt st, _TargetIt en) { ans.emplace_back(st, en); }, overlap);
+    return ans;
+  }
+
+  // 按顺序对每个匹配调用fn(first, last).
+  // 使用Galil规则: 匹配后按模式周期移动, 并且不再比较已知匹配的前缀.
+  // 因此即使是"aaaa"这样的周期模式, 找出全部k个匹配也是O(n + k)
+  template <typename _TargetIt, typename _Fn>
+  void for_each_match(_TargetIt first, _TargetIt last, _Fn fn, bool overlap = true) const {
+    auto pat_len = en_ - st_;
+    if (pat_len == 0) return;
+    // good_char_[0] = period + pat_len - 1, 见make_delta2的loop 1
+    auto period = good_char_[0] - (pat_len - 1);
+
+    auto stringlen = last - first;
+    _diff_type s = 0;     // 窗口起点
+    _diff_type memo = 0;  // 窗口的前memo个字符已知匹配
+    while (s + pat_len <= stringlen) {
+      this->_stats().on_attempt();
+      _diff_type j = pat_len - 1;
+      while (j >= memo && first[s + j] == st_[j]) --j;
+      if (j < memo) {
+        // match
+        this->_stats().on_compare(pat_len - memo);
+        this->_stats().on_match();
+        fn(first + s, first + s + pat_len);
+        if (overlap) {
+          s += period;
+          memo = pat_len - period;
+        } else {
+          s += pat_len;
+          memo = 0;
+        }
+      } else {
+        // not match, jump. 同operator()中的i += max(...), 换算成窗口起点
+        this->_stats().on_compare(pat_len - j);
+        auto bad = bad_char_(first[s + j]);
+        auto shift = j + std::max(bad, good_char_[j]) - (pat_len - 1);
+        this->_stats().on_shift(shift, good_char_[j] > bad);
+        s += shift;
+        memo = 0;
+      }
+    }
+  }
+
+ private:
+  // 连续的字节文本. 短模式用memchr/SIMD过滤, 长模式仍然跳跃
+  template <typename _TargetIt>
+  std::pair<_TargetIt, _TargetIt> _search(_TargetIt first, _TargetIt last,
+                                          std::true_type) const {
+    auto pat_len = en_ - st_;
+    auto stringlen = last - first;
+    if (pat_len > simd_max_pattern_ || stringlen < pat_len)
+      return _search(first, last, std::false_type());
+
+    auto s = reinterpret_cast<const unsigned char*>(&*first);
+    auto n = static_cast<std::size_t>(stringlen);
+    auto k = bm_detail::find_bytes(s, n, st_, static_cast<std::size_t>(pat_len));
+    if (k == n) return std::make_pair(last, last);
+    return std::make_pair(first + k, first + k + pat_len);
+  }
+
+  template <typename _TargetIt>
+  std::pair<_TargetIt, _TargetIt> _search(_TargetIt first, _TargetIt last,
+                                          std::false_type) const {
+    auto pat_len = en_ - st_;
     _diff_type i = pat_len - 1;
     auto stringlen = last - first;
     while (i < stringlen) {
+      this->_stats().on_attempt();
       _diff_type j = pat_len - 1;
       while (j >= 0 && first[i] == st_[j]) {
         --i;
@@ -38,64 +425,32 @@ class boyer_moore {
       }
       if (j < 0) {
         // match
+        this->_stats().on_compare(pat_len);
+        this->_stats().on_match();
         const auto match = first + i + 1;
         return std::make_pair(match, match + pat_len);
       }
       // not match, jump
-      i += std::max(bad_char_[first[i]], good_char_[j]);
+      this->_stats().on_compare(pat_len - j);
+      auto bad = bad_char_(first[i]);
+      auto shift = std::max(bad, good_char_[j]);
+      // 换算成窗口起点的移动距离
+      this->_stats().on_shift(j + shift - (pat_len - 1), good_char_[j] > bad);
+      i += shift;
     }
     return std::make_pair(last, last);
   }
 
- private:
-  // 判断字串[pos, end)是否是前缀
-  bool is_prefix(_It pat, _diff_type pat_len, _diff_type pos) {
-    _diff_type suffixlen = pat_len - pos;
-    for (_diff_type i = 0; i < suffixlen; ++i)
-      if (pat[i] != pat[pos + i]) return false;
-    return true;
-  }
-  // 返回[0, pos]和[0, pat_len)的共同后缀长度+1
-  _diff_type suffix_length(_It pat, _diff_type pat_len, _diff_type pos) {
-    _diff_type i = 0;
-    for (; pat[pos - i] == pat[pat_len - 1 - i] && i < pos; ++i)
-      ;
-    return i;
-  }
-
-  void make_delta1(_It pat, _diff_type pat_len) {
-    bad_char_.fill(pat_len);
-    if (pat_len > 0) {
-      for (_diff_type i = 0; i < pat_len; ++i) {
-        auto ch = pat[i];
-        auto uch = static_cast<typename std::make_unsigned<decltype(ch)>::type>(ch);
-        bad_char_[uch] = pat_len - 1 - i;
-      }
-    }
-  }
+  void make_delta1(_It pat, _diff_type pat_len) { bad_char_.build(pat, pat_len); }
 
-  void make_delta2(_It pat, _diff_type pat_len) {
-    if (pat_len == 0) return;
-    // loop 1, part match. 例如: lsp000alsp, 后缀alsp没匹配项, 但有部分匹配,
-    // ([a]lsp)000alsp这样的形式
-    _diff_type last_prefix_index = 1;
-    for (_diff_type i = pat_len - 1; i >= 0; --i) {
-      if (is_prefix(pat, pat_len, i + 1)) last_prefix_index = i + 1;
-      good_char_[i] = last_prefix_index + (pat_len - 1 - i);
-    }
-    // loop 2. full match. 例如: 00alspxalsp中, 后缀alsp匹配00(alsp)xalsp
-    for (_diff_type i = 0; i < pat_len - 1; ++i) {
-      auto slen = suffix_length(pat, pat_len, i);
-      auto pos = pat_len - 1 - slen;
-      if (pat[i - slen] != pat[pos]) good_char_[pos] = pat_len - 1 - i + slen;
-    }
-  }
+  void make_delta2(_It pat, _diff_type pat_len) { bm_detail::make_good_suffix(pat, pat_len, good_char_); }
 
  private:
   // BAD-CHARACTER RULE
   // delta1 table: delta1[c] contains the distance between the last
   // character of pattern and the rightmost occurrence of c in pattern.
-  std::array<_diff_type, 256> bad_char_;
+  // 单字节元素是256项的数组, 宽字符是哈希表. 见bm_default_bad_char
+  _BadChar bad_char_;
 
   // GOOD-SUFFIX RULE.
   // delta2 table: given a mismatch at pat[pos], we want to align
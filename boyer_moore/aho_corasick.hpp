@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <queue>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace wzj {
+
+// 多模式匹配. Aho-Corasick自动机(完全DFA) + Wu-Manber风格的跳跃前端.
+// 1. 模式和文本都必须是单字节元素(char/signed char/unsigned char), 同boyer_moore的bad_char_
+// 2. 一次扫描文本, 报告所有(模式id, 匹配区间). 模式id是构造时patterns中的下标
+// 3. 空模式被忽略
+// 4. 每个文本字符只查一次DFA表, 与模式个数无关
+template <typename _It>
+class aho_corasick {
+ public:
+  using _diff_type = typename std::iterator_traits<_It>::difference_type;
+
+ public:
+  explicit aho_corasick(const std::vector<std::pair<_It, _It>>& patterns)
+      : len_(patterns.size(), 0) {
+    static_assert(sizeof(typename std::iterator_traits<_It>::value_type) == 1,
+                  "aho_corasick only supports byte patterns");
+    build_trie(patterns);
+    build_links();
+    build_skip(patterns);
+  }
+
+  // 返回所有匹配(id, first, last), 按匹配结束位置升序.
+  // 结束位置相同时, 长的模式在前
+  template <typename _TargetIt>
+  std::vector<std::tuple<std::size_t, _TargetIt, _TargetIt>> operator()(
+      _TargetIt first, _TargetIt last) const {
+    std::vector<std::tuple<std::size_t, _TargetIt, _TargetIt>> ans;
+    (*this)(first, last, [&ans](std::size_t id, _TargetIt st, _TargetIt en) {
+      ans.emplace_back(id, st, en);
+    });
+    return ans;
+  }
+
+  // 回调版本, 对每个匹配调用fn(id, first, last). 不分配内存
+  template <typename _TargetIt, typename _Fn>
+  void operator()(_TargetIt first, _TargetIt last, _Fn fn) const {
+    if (out_ids_.empty()) return;
+
+    _diff_type i = 0;
+    auto stringlen = last - first;
+    std::int32_t state = 0;
+    while (i < stringlen) {
+      if (state == 0 && lmin_ > 1) {
+        // 处于根节点时, 没有未完成的前缀. 用窗口[i, i+lmin_)末尾的2个字节跳跃
+        while (i + lmin_ <= stringlen) {
+          auto s = skip_[block(first[i + lmin_ - 2], first[i + lmin_ - 1])];
+          if (s == 0) break;
+          i += s;
+        }
+        if (i + lmin_ > stringlen) return;  // 不可能再有匹配
+      }
+      state = delta_[static_cast<std::size_t>(state) * 256 + to_byte(first[i])];
+      ++i;
+      for (auto s = report_[state]; s > 0; s = dict_[s]) {
+        for (auto k = out_begin_[s]; k < out_begin_[s + 1]; ++k) {
+          auto id = out_ids_[k];
+          fn(id, first + (i - len_[id]), first + i);
+        }
+      }
+    }
+  }
+
+  std::size_t size() const { return len_.size(); }
+  // 最短非空模式的长度, 决定跳跃前端的最大步长
+  _diff_type min_length() const { return lmin_; }
+
+ private:
+  template <typename _Ch>
+  static std::uint8_t to_byte(_Ch ch) {
+    return static_cast<std::uint8_t>(ch);
+  }
+  template <typename _Ch>
+  static std::size_t block(_Ch a, _Ch b) {
+    return (static_cast<std::size_t>(to_byte(a)) << 8) | to_byte(b);
+  }
+
+  // 建立trie. delta_中-1表示还没有的边
+  void build_trie(const std::vector<std::pair<_It, _It>>& patterns) {
+    delta_.assign(256, -1);
+    std::vector<std::vector<std::size_t>> ids(1);
+    for (std::size_t id = 0; id < patterns.size(); ++id) {
+      auto pat = patterns[id].first;
+      auto pat_len = patterns[id].second - pat;
+      len_[id] = pat_len;
+      if (pat_len == 0) continue;
+
+      std::int32_t s = 0;
+      for (_diff_type j = 0; j < pat_len; ++j) {
+        auto& next = delta_[static_cast<std::size_t>(s) * 256 + to_byte(pat[j])];
+        if (next < 0) {
+          next = static_cast<std::int32_t>(ids.size());
+          ids.emplace_back();
+          // resize之后next会失效, 不能再使用
+          delta_.resize(delta_.size() + 256, -1);
+          s = static_cast<std::int32_t>(ids.size() - 1);
+        } else {
+          s = next;
+        }
+      }
+      ids[s].push_back(id);
+    }
+    // 长的模式先报告
+    out_begin_.assign(ids.size() + 1, 0);
+    for (std::size_t s = 0; s < ids.size(); ++s) {
+      std::sort(ids[s].begin(), ids[s].end(), [this](std::size_t a, std::size_t b) {
+        return len_[a] != len_[b] ? len_[a] > len_[b] : a < b;
+      });
+      out_begin_[s + 1] = out_begin_[s] + ids[s].size();
+      out_ids_.insert(out_ids_.end(), ids[s].begin(), ids[s].end());
+    }
+  }
+
+  // BFS求失败链接, 把trie补全成DFA. 同时建立输出链接:
+  // report_[s]是s的失败链(包括s)上第一个有输出的状态, dict_[s] = report_[fail(s)]
+  void build_links() {
+    auto n = out_begin_.size() - 1;
+    std::vector<std::int32_t> fail(n, 0);
+    report_.assign(n, 0);
+    dict_.assign(n, 0);
+
+    std::queue<std::int32_t> q;
+    for (int c = 0; c < 256; ++c) {
+      auto& next = delta_[c];
+      if (next < 0) {
+        next = 0;
+      } else {
+        fail[next] = 0;
+        q.push(next);
+      }
+    }
+    while (!q.empty()) {
+      auto s = q.front();
+      q.pop();
+      dict_[s] = report_[fail[s]];
+      report_[s] = has_output(s) ? s : dict_[s];
+      for (int c = 0; c < 256; ++c) {
+        auto& next = delta_[static_cast<std::size_t>(s) * 256 + c];
+        auto via_fail = delta_[static_cast<std::size_t>(fail[s]) * 256 + c];
+        if (next < 0) {
+          next = via_fail;
+        } else {
+          fail[next] = via_fail;
+          q.push(next);
+        }
+      }
+    }
+  }
+
+  // Wu-Manber跳跃表, 块大小为2.
+  // 处于根节点时, 若窗口[i, i+lmin_)末尾的块在任何模式前lmin_个字符中都没有出现在
+  // 距离末尾k以内的位置, 那么从i, i+1, ..., i+shift-1开始都不可能匹配
+  void build_skip(const std::vector<std::pair<_It, _It>>& patterns) {
+    lmin_ = 0;
+    for (auto l : len_)
+      if (l > 0 && (lmin_ == 0 || l < lmin_)) lmin_ = l;
+    if (lmin_ < 2) return;
+
+    // 窗口末尾的块是(x, p[0])时, 模式可能从i+lmin_-1开始, 所以默认值是lmin_-1.
+    // 用uint8_t保存, 截断成255只会让跳跃变短, 不影响正确性
+    auto def = static_cast<std::uint8_t>(std::min<_diff_type>(lmin_ - 1, 255));
+    skip_.assign(1 << 16, def);
+    for (auto& p : patterns) {
+      if (p.second - p.first == 0) continue;
+      for (_diff_type j = 1; j < lmin_; ++j) {
+        auto& s = skip_[block(p.first[j - 1], p.first[j])];
+        s = std::min(s, static_cast<std::uint8_t>(std::min<_diff_type>(lmin_ - 1 - j, 255)));
+      }
+    }
+  }
+
+  bool has_output(std::int32_t s) const { return out_begin_[s + 1] > out_begin_[s]; }
+
+ private:
+  // 完全DFA: delta_[s*256+c]是状态s读入c之后的状态
+  std::vector<std::int32_t> delta_;
+  // 输出链接, 见build_links
+  std::vector<std::int32_t> report_;
+  std::vector<std::int32_t> dict_;
+  // 状态s上结束的模式id是out_ids_[out_begin_[s], out_begin_[s+1])
+  std::vector<std::size_t> out_begin_;
+  std::vector<std::size_t> out_ids_;
+  // 每个模式的长度
+  std::vector<_diff_type> len_;
+
+  // 跳跃前端
+  _diff_type lmin_ = 0;
+  std::vector<std::uint8_t> skip_;
+};
+}  // namespace wzj
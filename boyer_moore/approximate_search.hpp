@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace wzj {
+namespace bm_detail {
+// 按位并行算法中, 模式的第i个字符对应第i/64个字的第i%64位
+using bit_word = std::uint64_t;
+
+// peq[c*words + w]: 模式中等于c的位置
+template <typename _It>
+std::vector<bit_word> make_peq(_It pat, std::ptrdiff_t pat_len, std::size_t words) {
+  static_assert(sizeof(typename std::iterator_traits<_It>::value_type) == 1,
+                "approximate search only supports byte patterns");
+  std::vector<bit_word> peq(256 * words, 0);
+  for (std::ptrdiff_t i = 0; i < pat_len; ++i)
+    peq[static_cast<unsigned char>(pat[i]) * words + i / 64] |= bit_word(1) << (i % 64);
+  return peq;
+}
+}  // namespace bm_detail
+
+// 最多k个错配(Hamming距离)的近似匹配. Shift-And算法, k+1组位向量:
+// R_d的第i位为1, 表示pat[0, i]和以当前字符结尾的文本最多有d个错配.
+// 模式超过64时使用多个字. 每个文本字符的代价是O((k+1) * ceil(m/64))
+template <typename _It>
+class hamming_searcher {
+ public:
+  using _diff_type = typename std::iterator_traits<_It>::difference_type;
+
+ public:
+  hamming_searcher(_It first, _It last, int k)
+      : pat_len_(last - first),
+        words_((pat_len_ + 63) / 64),
+        k_(k),
+        peq_(bm_detail::make_peq(first, pat_len_, words_)) {}
+
+  // 按顺序对每个匹配调用fn(end, distance). [end - pat_len, end)和模式有distance(<=k)个错配
+  template <typename _TargetIt, typename _Fn>
+  void for_each_match(_TargetIt first, _TargetIt last, _Fn fn) const {
+    if (pat_len_ == 0) return;
+    using bm_detail::bit_word;
+    auto W = words_;
+    std::vector<bit_word> R((k_ + 1) * W, 0), prev(W);
+    const bit_word high = bit_word(1) << ((pat_len_ - 1) % 64);
+
+    auto stringlen = last - first;
+    for (_diff_type j = 0; j < stringlen; ++j) {
+      const bit_word* eq = &peq_[static_cast<unsigned char>(first[j]) * W];
+      // prev保存R_{d-1}更新之前左移并置1的结果
+      for (int d = 0; d <= k_; ++d) {
+        bit_word* r = &R[d * W];
+        bit_word carry = 1;
+        for (std::size_t w = 0; w < W; ++w) {
+          bit_word shifted = (r[w] << 1) | carry;
+          carry = r[w] >> 63;
+          r[w] = shifted & eq[w];
+          if (d > 0) r[w] |= prev[w];
+          prev[w] = shifted;
+        }
+      }
+      if (j + 1 < pat_len_) continue;
+      for (int d = 0; d <= k_; ++d)
+        if (R[d * W + W - 1] & high) {
+          fn(first + (j + 1), d);
+          break;
+        }
+    }
+  }
+
+  // 返回第一个匹配的(end, distance). 没有匹配返回(last, -1)
+  template <typename _TargetIt>
+  std::pair<_TargetIt, int> operator()(_TargetIt first, _TargetIt last) const {
+    std::pair<_TargetIt, int> ans(last, -1);
+    // 找到第一个之后, 剩下的匹配不再记录
+    for_each_match(first, last, [&ans](_TargetIt end, int d) {
+      if (ans.second < 0) ans = std::make_pair(end, d);
+    });
+    return ans;
+  }
+
+  _diff_type size() const { return pat_len_; }
+
+ private:
+  _diff_type pat_len_;
+  std::size_t words_;
+  int k_;
+  std::vector<bm_detail::bit_word> peq_;
+};
+
+// 最多k个编辑(插入, 删除, 替换)的近似匹配. Myers的按位并行算法,
+// 模式超过64时按64位分块, 块之间传递水平方向的差值(Myers 1999, 4.2节).
+// 只保存DP矩阵一列的增量: Pv/Mv的第i位表示D[i+1][j] - D[i][j]是+1/-1.
+// 每个文本字符的代价是O(ceil(m/64))
+template <typename _It>
+class myers_searcher {
+ public:
+  using _diff_type = typename std::iterator_traits<_It>::difference_type;
+
+ public:
+  myers_searcher(_It first, _It last, int k)
+      : pat_len_(last - first),
+        words_((pat_len_ + 63) / 64),
+        k_(k),
+        peq_(bm_detail::make_peq(first, pat_len_, words_)) {}
+
+  // 按顺序对每个文本位置调用fn(end, distance), distance(<=k)是模式和以end结尾的某个子串的最小编辑距离
+  template <typename _TargetIt, typename _Fn>
+  void for_each_match(_TargetIt first, _TargetIt last, _Fn fn) const {
+    if (pat_len_ == 0) return;
+    using bm_detail::bit_word;
+    auto W = words_;
+    std::vector<bit_word> Pv(W, ~bit_word(0)), Mv(W, 0);
+    const bit_word last_high = bit_word(1) << ((pat_len_ - 1) % 64);
+    _diff_type score = pat_len_;  // D[m][j]
+
+    auto stringlen = last - first;
+    for (_diff_type j = 0; j < stringlen; ++j) {
+      const bit_word* eq = &peq_[static_cast<unsigned char>(first[j]) * W];
+      int hin = 0;  // 第0行是0, 即匹配可以从任意位置开始
+      for (std::size_t w = 0; w < W; ++w) {
+        hin = advance_block(Pv[w], Mv[w], eq[w], hin, w + 1 == W ? last_high : bit_word(1) << 63);
+      }
+      score += hin;
+      if (score <= k_) fn(first + (j + 1), static_cast<int>(score));
+    }
+  }
+
+  // 返回第一个匹配的(end, distance). 没有匹配返回(last, -1)
+  template <typename _TargetIt>
+  std::pair<_TargetIt, int> operator()(_TargetIt first, _TargetIt last) const {
+    std::pair<_TargetIt, int> ans(last, -1);
+    for_each_match(first, last, [&ans](_TargetIt end, int d) {
+      if (ans.second < 0) ans = std::make_pair(end, d);
+    });
+    return ans;
+  }
+
+  _diff_type size() const { return pat_len_; }
+
+ private:
+  // 处理一块, hin是从上一块传来的水平差值, 返回这一块最后一行(high)的水平差值
+  static int advance_block(bm_detail::bit_word& Pv, bm_detail::bit_word& Mv, bm_detail::bit_word Eq,
+                           int hin, bm_detail::bit_word high) {
+    using bm_detail::bit_word;
+    bit_word Xv = Eq | Mv;
+    if (hin < 0) Eq |= 1;
+    bit_word Xh = (((Eq & Pv) + Pv) ^ Pv) | Eq;
+    bit_word Ph = Mv | ~(Xh | Pv);
+    bit_word Mh = Pv & Xh;
+    int hout = 0;
+    if (Ph & high)
+      hout = 1;
+    else if (Mh & high)
+      hout = -1;
+    Ph <<= 1;
+    Mh <<= 1;
+    if (hin < 0)
+      Mh |= 1;
+    else if (hin > 0)
+      Ph |= 1;
+    Pv = Mh | ~(Xv | Ph);
+    Mv = Ph & Xv;
+    return hout;
+  }
+
+ private:
+  _diff_type pat_len_;
+  std::size_t words_;
+  int k_;
+  std::vector<bm_detail::bit_word> peq_;
+};
+}  // namespace wzj
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "Boyer_Moore.hpp"
+#include "worker_pool.hpp"
+
+namespace wzj {
+namespace bm_detail {
+// 每个任务处理的记录数. 是64的倍数, 不同任务不会写同一个bitmap字
+constexpr std::size_t batch_task_records = 4096;
+
+// 在记录rec中查找. 记录是有data()和size()的单字节字符串(std::string_view, std::string等)
+template <typename _Searcher, typename _Record>
+bool record_hit(const _Searcher& s, const _Record& rec) {
+  auto first = rec.data();
+  auto last = first + rec.size();
+  return s.size() == 0 || s(first, last).first != last;
+}
+}  // namespace bm_detail
+
+// 用同一个预先建好的searcher(boyer_moore, compact_boyer_moore, searcher...)搜索所有记录.
+// 返回bitmap, 第i条记录有匹配时, 第i/64个字的第i%64位为1.
+// pool为nullptr时在调用线程中完成
+template <typename _Searcher, typename _RecIt>
+std::vector<std::uint64_t> batch_search_bitmap(const _Searcher& s, _RecIt first, _RecIt last,
+                                               worker_pool* pool = nullptr) {
+  auto n = static_cast<std::size_t>(last - first);
+  std::vector<std::uint64_t> bitmap((n + 63) / 64, 0);
+  auto task = [&](std::size_t t) {
+    auto st = t * bm_detail::batch_task_records;
+    auto en = std::min(n, st + bm_detail::batch_task_records);
+    for (auto i = st; i < en; ++i)
+      if (bm_detail::record_hit(s, first[i])) bitmap[i / 64] |= std::uint64_t(1) << (i % 64);
+  };
+  auto tasks = (n + bm_detail::batch_task_records - 1) / bm_detail::batch_task_records;
+  if (pool) {
+    pool->parallel_for(tasks, task);
+  } else {
+    for (std::size_t t = 0; t < tasks; ++t) task(t);
+  }
+  return bitmap;
+}
+
+// 同batch_search_bitmap, 返回有匹配的记录下标, 升序
+template <typename _Searcher, typename _RecIt>
+std::vector<std::size_t> batch_search_indices(const _Searcher& s, _RecIt first, _RecIt last,
+                                              worker_pool* pool = nullptr) {
+  auto bitmap = batch_search_bitmap(s, first, last, pool);
+  std::vector<std::size_t> ans;
+  for (std::size_t w = 0; w < bitmap.size(); ++w)
+    for (auto bits = bitmap[w]; bits; bits &= bits - 1)
+      ans.push_back(w * 64 + bm_detail::lowest_bit(bits));
+  return ans;
+}
+}  // namespace wzj
@@ -0,0 +1,266 @@
+// 字符串搜索的基准测试. 比较wzj::boyer_moore, std::boyer_moore_searcher,
+// std::boyer_moore_horspool_searcher, std::search和memmem.
+// 语料: dna(ACGT), english(按Zipf分布抽取的常用词), binary(均匀随机字节), periodic(短串重复).
+// 模式长度1, 2, 4, ..., 1024. 每个组合先预热, 再重复多次, 统计数出所有匹配(可重叠)的时间.
+// 预处理不计时. 结果写成CSV或JSON, 便于比较不同版本
+//
+// usage: bm_bench [-n bytes] [-r reps] [-w warmup] [-t seconds] [-f csv|json] [-o file]
+//   -n  每个语料的字节数, 默认8MB
+//   -r  计时的重复次数, 默认5
+//   -w  预热次数, 默认1
+//   -t  单个组合的时间预算(秒), 预热已经超过预算时减少重复次数. 默认2
+//   -f  输出格式, 默认csv
+//   -o  输出文件, 默认stdout
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boyer_moore/Boyer_Moore.hpp>
+
+namespace {
+struct options {
+  std::size_t bytes = 8 << 20;
+  int reps = 5;
+  int warmup = 1;
+  double budget = 2.0;
+  std::string format = "csv";
+  std::string output;
+};
+
+struct result {
+  std::string corpus;
+  std::string engine;
+  std::size_t pattern_len;
+  std::size_t bytes;
+  int reps;
+  std::size_t matches;
+  double best_ns;
+  double median_ns;
+};
+
+std::string make_dna(std::size_t n, std::mt19937_64& rng) {
+  std::string s(n, 0);
+  for (auto& c : s) c = "ACGT"[rng() % 4];
+  return s;
+}
+
+std::string make_english(std::size_t n, std::mt19937_64& rng) {
+  static const char* words[] = {
+      "the",   "of",    "and",   "to",     "a",      "in",    "is",     "you",   "that",   "it",
+      "he",    "was",   "for",   "on",     "are",    "as",    "with",   "his",   "they",   "at",
+      "be",    "this",  "have",  "from",   "or",     "one",   "had",    "by",    "word",   "but",
+      "not",   "what",  "all",   "were",   "we",     "when",  "your",   "can",   "said",   "there",
+      "use",   "an",    "each",  "which",  "she",    "do",    "how",    "their", "if",     "will",
+      "up",    "other", "about", "out",    "many",   "then",  "them",   "these", "so",     "some",
+      "her",   "would", "make",  "like",   "him",    "into",  "time",   "has",   "look",   "two",
+      "more",  "write", "go",    "see",    "number", "no",    "way",    "could", "people", "my",
+      "than",  "first", "water", "been",   "call",   "who",   "oil",    "its",   "now",    "find",
+      "long",  "down",  "day",   "did",    "get",    "come",  "made",   "may",   "part",   "search"};
+  const int vocab = sizeof(words) / sizeof(words[0]);
+  // Zipf: 第k个词的权重是1/(k+1)
+  std::vector<double> weights(vocab);
+  for (int k = 0; k < vocab; ++k) weights[k] = 1.0 / (k + 1);
+  std::discrete_distribution<int> pick(weights.begin(), weights.end());
+  std::string s;
+  s.reserve(n + 16);
+  bool sentence_start = true;
+  while (s.size() < n) {
+    std::string w = words[pick(rng)];
+    if (sentence_start) w[0] = static_cast<char>(w[0] - 'a' + 'A');
+    s += w;
+    sentence_start = rng() % 12 == 0;
+    s += sentence_start ? ". " : (rng() % 10 == 0 ? ", " : " ");
+  }
+  s.resize(n);
+  return s;
+}
+
+std::string make_binary(std::size_t n, std::mt19937_64& rng) {
+  std::string s(n, 0);
+  for (auto& c : s) c = static_cast<char>(rng() & 0xff);
+  return s;
+}
+
+std::string make_periodic(std::size_t n, std::mt19937_64&) {
+  std::string s(n, 0);
+  for (std::size_t i = 0; i < n; ++i) s[i] = "aaab"[i % 4];
+  return s;
+}
+
+// 从语料中取模式. periodic语料把模式最后一个字符改掉, 使它不出现, 这是逐位比较的最坏情况
+std::string make_pattern(const std::string& corpus, const std::string& name, std::size_t m,
+                         std::mt19937_64& rng) {
+  auto pos = rng() % (corpus.size() - m);
+  auto p = corpus.substr(pos, m);
+  if (name == "periodic") p.back() = 'c';
+  return p;
+}
+
+// 从first开始反复查找第一个匹配, 每次从上一个匹配的下一个位置继续
+template <typename _Find>
+std::size_t count_matches(const char* first, const char* last, _Find find) {
+  std::size_t cnt = 0;
+  for (auto it = first;;) {
+    auto hit = find(it, last);
+    if (hit == last) break;
+    ++cnt;
+    it = hit + 1;
+  }
+  return cnt;
+}
+
+using engine_fn = std::function<std::size_t(const char*, const char*)>;
+
+std::vector<std::pair<std::string, engine_fn>> make_engines(const std::string& pat) {
+  std::vector<std::pair<std::string, engine_fn>> engines;
+  auto pb = pat.data(), pe = pat.data() + pat.size();
+
+  auto bm = std::make_shared<wzj::boyer_moore<const char*>>(pb, pe);
+  engines.emplace_back("wzj::boyer_moore", [bm](const char* first, const char* last) {
+    return count_matches(first, last, [&](const char* b, const char* e) { return (*bm)(b, e).first; });
+  });
+  auto std_bm = std::make_shared<std::boyer_moore_searcher<const char*>>(pb, pe);
+  engines.emplace_back("std::boyer_moore_searcher", [std_bm](const char* first, const char* last) {
+    return count_matches(first, last, [&](const char* b, const char* e) { return (*std_bm)(b, e).first; });
+  });
+  auto std_bmh = std::make_shared<std::boyer_moore_horspool_searcher<const char*>>(pb, pe);
+  engines.emplace_back("std::boyer_moore_horspool_searcher", [std_bmh](const char* first, const char* last) {
+    return count_matches(first, last, [&](const char* b, const char* e) { return (*std_bmh)(b, e).first; });
+  });
+  engines.emplace_back("std::search", [pb, pe](const char* first, const char* last) {
+    return count_matches(first, last, [&](const char* b, const char* e) { return std::search(b, e, pb, pe); });
+  });
+#ifndef _WIN32
+  auto m = pat.size();
+  engines.emplace_back("memmem", [pb, m](const char* first, const char* last) {
+    return count_matches(first, last, [&](const char* b, const char* e) {
+      auto p = static_cast<const char*>(memmem(b, static_cast<std::size_t>(e - b), pb, m));
+      return p ? p : e;
+    });
+  });
+#endif
+  return engines;
+}
+
+double elapsed_ns(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool parse_args(int argc, char* argv[], options& opt) {
+  for (int i = 1; i < argc; ++i) {
+    if (i + 1 == argc) return false;
+    std::string flag = argv[i], value = argv[++i];
+    if (flag == "-n")
+      opt.bytes = std::strtoull(value.c_str(), nullptr, 10);
+    else if (flag == "-r")
+      opt.reps = std::atoi(value.c_str());
+    else if (flag == "-w")
+      opt.warmup = std::atoi(value.c_str());
+    else if (flag == "-t")
+      opt.budget = std::atof(value.c_str());
+    else if (flag == "-f")
+      opt.format = value;
+    else if (flag == "-o")
+      opt.output = value;
+    else
+      return false;
+  }
+  return opt.bytes > 2048 && opt.reps > 0 && opt.warmup >= 0 && (opt.format == "csv" || opt.format == "json");
+}
+
+void write_results(std::ostream& out, const std::vector<result>& results, const std::string& format) {
+  auto ns_per_byte = [](const result& r) { return r.median_ns / r.bytes; };
+  auto gb_per_s = [](const result& r) { return r.bytes / r.median_ns; };
+  if (format == "csv") {
+    out << "corpus,engine,pattern_len,bytes,reps,matches,best_ns,median_ns,ns_per_byte,gb_per_s\n";
+    for (auto& r : results)
+      out << r.corpus << "," << r.engine << "," << r.pattern_len << "," << r.bytes << "," << r.reps << ","
+          << r.matches << "," << r.best_ns << "," << r.median_ns << "," << ns_per_byte(r) << "," << gb_per_s(r)
+          << "\n";
+    return;
+  }
+  out << "[\n";
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    auto& r = results[i];
+    out << "  {\"corpus\": \"" << r.corpus << "\", \"engine\": \"" << r.engine << "\", \"pattern_len\": "
+        << r.pattern_len << ", \"bytes\": " << r.bytes << ", \"reps\": " << r.reps << ", \"matches\": "
+        << r.matches << ", \"best_ns\": " << r.best_ns << ", \"median_ns\": " << r.median_ns
+        << ", \"ns_per_byte\": " << ns_per_byte(r) << ", \"gb_per_s\": " << gb_per_s(r) << "}"
+        << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  out << "]\n";
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  options opt;
+  if (!parse_args(argc, argv, opt)) {
+    std::cerr << "usage: " << argv[0] << " [-n bytes] [-r reps] [-w warmup] [-t seconds] [-f csv|json] [-o file]"
+              << std::endl;
+    return 2;
+  }
+
+  std::mt19937_64 rng(20240601);
+  using generator = std::string (*)(std::size_t, std::mt19937_64&);
+  std::vector<std::pair<std::string, generator>> corpora = {
+      {"dna", make_dna}, {"english", make_english}, {"binary", make_binary}, {"periodic", make_periodic}};
+
+  std::vector<result> results;
+  bool consistent = true;
+  for (auto& corpus : corpora) {
+    auto text = corpus.second(opt.bytes, rng);
+    auto first = text.data(), last = text.data() + text.size();
+    for (std::size_t m = 1; m <= 1024; m *= 2) {
+      auto pat = make_pattern(text, corpus.first, m, rng);
+      std::size_t expect = 0;
+      bool have_expect = false;
+      for (auto& engine : make_engines(pat)) {
+        result r{corpus.first, engine.first, m, text.size(), opt.reps, 0, 0, 0};
+        // 预热, 并根据预热的时间决定重复次数
+        double warm_ns = 0;
+        for (int i = 0; i < opt.warmup; ++i) {
+          auto start = std::chrono::steady_clock::now();
+          r.matches = engine.second(first, last);
+          warm_ns = elapsed_ns(start);
+        }
+        if (warm_ns > 0) r.reps = std::max(1, std::min(opt.reps, static_cast<int>(opt.budget * 1e9 / warm_ns)));
+        std::vector<double> times;
+        for (int i = 0; i < r.reps; ++i) {
+          auto start = std::chrono::steady_clock::now();
+          r.matches = engine.second(first, last);
+          times.push_back(elapsed_ns(start));
+        }
+        std::sort(times.begin(), times.end());
+        r.best_ns = times.front();
+        r.median_ns = times[times.size() / 2];
+        if (have_expect && r.matches != expect) {
+          std::cerr << corpus.first << " m=" << m << ": " << engine.first << " found " << r.matches
+                    << " matches, expected " << expect << std::endl;
+          consistent = false;
+        }
+        expect = r.matches;
+        have_expect = true;
+        std::cerr << corpus.first << "\tm=" << m << "\t" << engine.first << "\t" << r.bytes / r.median_ns
+                  << " GB/s" << std::endl;
+        results.push_back(r);
+      }
+    }
+  }
+
+  if (opt.output.empty()) {
+    write_results(std::cout, results, opt.format);
+  } else {
+    std::ofstream out(opt.output);
+    write_results(out, results, opt.format);
+  }
+  // 各个算法的匹配个数不一致时返回1
+  return consistent ? 0 : 1;
+}
@@ -0,0 +1,46 @@
+// 命令行工具: 在文件中查找固定字符串, 输出每个匹配的字节偏移
+// usage: bm_grep [-c] [-1] pattern file...
+//   -c  只输出匹配个数
+//   -1  只找第一个匹配
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boyer_moore/mapped_file.h>
+
+int main(int argc, char* argv[]) {
+  bool count_only = false, first_only = false;
+  int i = 1;
+  for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; ++i) {
+    if (std::strcmp(argv[i], "-c") == 0)
+      count_only = true;
+    else if (std::strcmp(argv[i], "-1") == 0)
+      first_only = true;
+    else
+      break;
+  }
+  if (argc - i < 2) {
+    std::cerr << "usage: " << argv[0] << " [-c] [-1] pattern file..." << std::endl;
+    return 2;
+  }
+
+  std::string pattern = argv[i++];
+  bool found = false, failed = false;
+  for (; i < argc; ++i) {
+    std::vector<std::size_t> offsets;
+    if (!wzj::search_file(argv[i], pattern, offsets, first_only)) {
+      std::cerr << argv[i] << ": cannot open" << std::endl;
+      failed = true;
+      continue;
+    }
+    found = found || !offsets.empty();
+    if (count_only) {
+      std::cout << argv[i] << ":" << offsets.size() << "\n";
+    } else {
+      for (auto off : offsets) std::cout << argv[i] << ":" << off << "\n";
+    }
+  }
+  // 同grep: 0有匹配, 1无匹配, 2出错
+  return failed ? 2 : (found ? 0 : 1);
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include "Boyer_Moore.hpp"
+
+namespace wzj {
+
+// 分块输入的boyer_moore. 每次feed一个块, 报告所有在这个块里结束的匹配.
+// 1. 只保留上一块末尾的pat_len-1个元素, 用来找跨块的匹配. 内存是O(pattern)
+// 2. 报告的是匹配在整个流中的起始偏移, 包括重叠的匹配
+// 3. 和boyer_moore一样, 只保存模式的迭代器, 模式必须比searcher活得久
+// 4. 空模式不报告任何匹配
+template <typename _It>
+class boyer_moore_stream {
+ public:
+  using _diff_type = typename std::iterator_traits<_It>::difference_type;
+  using _value_type = typename std::iterator_traits<_It>::value_type;
+
+ public:
+  boyer_moore_stream(_It first, _It last) : bm_(first, last), pat_len_(last - first) {
+    if (pat_len_ > 0) carry_.reserve(2 * (pat_len_ - 1));
+  }
+
+  // 输入下一块[first, last). 对每个匹配调用fn(offset), offset是匹配在流中的起始位置
+  template <typename _ChunkIt, typename _Fn>
+  void feed(_ChunkIt first, _ChunkIt last, _Fn fn) {
+    auto chunk_len = last - first;
+    if (pat_len_ == 0 || chunk_len == 0) {
+      consumed_ += chunk_len;
+      return;
+    }
+    auto carry_len = static_cast<_diff_type>(carry_.size());
+    auto base = consumed_ - carry_len;  // carry_[0]在流中的偏移
+
+    // 1. 跨块的匹配: 起点在carry_中, 终点在这一块中
+    if (carry_len > 0) {
+      auto head = std::min<_diff_type>(chunk_len, pat_len_ - 1);
+      carry_.insert(carry_.end(), first, first + head);
+      _find_all(carry_.cbegin(), carry_.cend(), carry_len,
+                [&](_diff_type pos) { fn(base + pos); });
+      carry_.resize(carry_len);
+    }
+    // 2. 整个在这一块中的匹配
+    _find_all(first, last, chunk_len, [&](_diff_type pos) { fn(consumed_ + pos); });
+
+    // 3. 保留(carry_ + 块)的最后pat_len-1个元素
+    auto keep = pat_len_ - 1;
+    if (chunk_len >= keep) {
+      carry_.assign(last - keep, last);
+    } else {
+      carry_.insert(carry_.end(), first, last);
+      if (static_cast<_diff_type>(carry_.size()) > keep)
+        carry_.erase(carry_.begin(), carry_.end() - keep);
+    }
+    consumed_ += chunk_len;
+  }
+
+  // 清空状态, 开始一个新的流
+  void reset() {
+    carry_.clear();
+    consumed_ = 0;
+  }
+
+  // 已经输入的元素个数
+  _diff_type consumed() const { return consumed_; }
+
+ private:
+  // 对[first, last)中所有起点 < limit 的匹配调用fn(起点)
+  template <typename _TargetIt, typename _Fn>
+  void _find_all(_TargetIt first, _TargetIt last, _diff_type limit, _Fn fn) const {
+    bm_.for_each_match(first, last, [&](_TargetIt st, _TargetIt) {
+      if (st - first < limit) fn(st - first);
+    });
+  }
+
+ private:
+  boyer_moore<_It> bm_;
+  _diff_type pat_len_;
+
+  std::vector<_value_type> carry_;  // 上一块末尾的pat_len-1个元素
+  _diff_type consumed_ = 0;
+};
+}  // namespace wzj
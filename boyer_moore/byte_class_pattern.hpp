@@ -0,0 +1,216 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Boyer_Moore.hpp"
+
+namespace wzj {
+
+// 带通配符和字符类的字节模式. 语法:
+//   ?         任意字节
+//   [abc]     字符类, 支持范围[0-9a-f]和取反[^...]. 不能为空
+//   \x        转义, x按字面匹配
+//   其他字符   按字面匹配
+// 每个位置编译成一个256位的集合. 能写成(byte & and) == eq的位置(字面量, ?, [Aa], [0-7]等)
+// 用SIMD每次验证16个位置, 其余字符类逐个查表.
+// 用最长的字面量片段做Horspool跳跃, 找到片段后再验证整个模式
+class byte_class_pattern {
+ public:
+  explicit byte_class_pattern(const std::string& expr) { valid_ = compile(expr); }
+
+  // 表达式格式是否正确. 不正确时不匹配任何文本
+  bool valid() const { return valid_; }
+  std::size_t size() const { return sets_.size(); }
+
+  // 返回第一次匹配的区间. 如果不匹配, 则返回(last,last). 文本必须是连续的字节
+  template <typename _TargetIt>
+  std::pair<_TargetIt, _TargetIt> operator()(_TargetIt first, _TargetIt last) const {
+    static_assert(bm_detail::is_contiguous_byte_iter<_TargetIt>::value,
+                  "byte_class_pattern needs contiguous byte text");
+    if (!valid_) return std::make_pair(last, last);
+    if (sets_.empty()) return std::make_pair(first, first);
+    auto n = static_cast<std::size_t>(last - first);
+    if (n < sets_.size()) return std::make_pair(last, last);
+
+    auto s = reinterpret_cast<const unsigned char*>(&*first);
+    auto k = _find(s, n, 0);
+    if (k == n) return std::make_pair(last, last);
+    return std::make_pair(first + k, first + k + sets_.size());
+  }
+
+  // 按顺序对每个(可重叠的)匹配调用fn(first, last)
+  template <typename _TargetIt, typename _Fn>
+  void for_each_match(_TargetIt first, _TargetIt last, _Fn fn) const {
+    static_assert(bm_detail::is_contiguous_byte_iter<_TargetIt>::value,
+                  "byte_class_pattern needs contiguous byte text");
+    auto n = static_cast<std::size_t>(last - first);
+    if (!valid_ || sets_.empty() || n < sets_.size()) return;
+    auto s = reinterpret_cast<const unsigned char*>(&*first);
+    for (auto k = _find(s, n, 0); k < n; k = _find(s, n, k + 1))
+      fn(first + k, first + k + sets_.size());
+  }
+
+  // 位置i是否接受字节c
+  bool accepts(std::size_t i, unsigned char c) const { return sets_[i][c]; }
+
+ private:
+  bool compile(const std::string& expr) {
+    for (std::size_t i = 0; i < expr.size(); ++i) {
+      std::bitset<256> set;
+      auto c = static_cast<unsigned char>(expr[i]);
+      if (c == '?') {
+        set.set();
+      } else if (c == '\\') {
+        if (++i == expr.size()) return false;
+        set.set(static_cast<unsigned char>(expr[i]));
+      } else if (c == '[') {
+        bool negate = i + 1 < expr.size() && expr[i + 1] == '^';
+        if (negate) ++i;
+        bool closed = false;
+        std::size_t items = 0;
+        while (++i < expr.size()) {
+          auto lo = static_cast<unsigned char>(expr[i]);
+          if (lo == ']') {
+            closed = true;
+            break;
+          }
+          ++items;
+          if (lo == '\\') {
+            if (++i == expr.size()) return false;
+            lo = static_cast<unsigned char>(expr[i]);
+          }
+          auto hi = lo;
+          if (i + 2 < expr.size() && expr[i + 1] == '-' && expr[i + 2] != ']') {
+            hi = static_cast<unsigned char>(expr[i + 2]);
+            i += 2;
+            if (hi < lo) return false;
+          }
+          for (unsigned b = lo; b <= hi; ++b) set.set(b);
+        }
+        // 空的字符类([]或[^])多半是笔误, 和没有闭合的[一样视为格式错误
+        if (!closed || items == 0) return false;
+        if (negate) set.flip();
+      } else {
+        set.set(c);
+      }
+      sets_.push_back(set);
+    }
+    build_masks();
+    build_skip();
+    return true;
+  }
+
+  // 集合S能写成{b : (b & and) == eq}, 当且仅当 |S| == 2^(and中0的个数), and是所有成员都相同的位
+  void build_masks() {
+    auto m = sets_.size();
+    // 补齐到16的倍数, and = eq = 0的位置总是通过
+    and_.assign((m + 15) / 16 * 16, 0);
+    eq_.assign(and_.size(), 0);
+    for (std::size_t i = 0; i < m; ++i) {
+      auto& set = sets_[i];
+      if (set.none()) {
+        // 空集合不可能匹配, 只能逐个检查
+        slow_.push_back(i);
+        continue;
+      }
+      unsigned first = 0;
+      while (!set[first]) ++first;
+      unsigned differ = 0;
+      for (unsigned b = 0; b < 256; ++b)
+        if (set[b]) differ |= b ^ first;
+      auto agree = static_cast<unsigned char>(~differ);
+      int free_bits = 0;
+      for (unsigned b = differ; b; b &= b - 1) ++free_bits;
+      if (set.count() == (std::size_t(1) << free_bits)) {
+        and_[i] = agree;
+        eq_[i] = static_cast<unsigned char>(first & agree);
+      } else {
+        slow_.push_back(i);
+      }
+    }
+  }
+
+  // 找最长的字面量片段[run_st_, run_st_ + run_len_), 建Horspool表
+  void build_skip() {
+    std::size_t best = 0, best_st = 0;
+    for (std::size_t i = 0; i < sets_.size();) {
+      if (sets_[i].count() != 1) {
+        ++i;
+        continue;
+      }
+      auto j = i;
+      while (j < sets_.size() && sets_[j].count() == 1) ++j;
+      if (j - i > best) {
+        best = j - i;
+        best_st = i;
+      }
+      i = j;
+    }
+    run_st_ = best_st;
+    run_.clear();
+    for (std::size_t i = 0; i < best; ++i) run_.push_back(eq_[best_st + i]);
+    if (best == 0) return;
+    shift_.fill(best);
+    for (std::size_t i = 0; i + 1 < best; ++i) shift_[run_[i]] = best - 1 - i;
+  }
+
+  // s[k, k+m)是否匹配
+  bool _verify(const unsigned char* s) const {
+    auto m = sets_.size();
+    std::size_t i = 0;
+#ifdef WZJ_BM_SIMD_WIDTH
+    for (; i + 16 <= m; i += 16) {
+      __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+      __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(and_.data() + i));
+      __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(eq_.data() + i));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(t, a), e)) != 0xffff) return false;
+    }
+#endif
+    for (; i < m; ++i)
+      if ((s[i] & and_[i]) != eq_[i]) return false;
+    for (auto p : slow_)
+      if (!sets_[p][s[p]]) return false;
+    return true;
+  }
+
+  // 返回起点 >= from 的第一个匹配, 没有返回n
+  std::size_t _find(const unsigned char* s, std::size_t n, std::size_t from) const {
+    auto m = sets_.size();
+    if (n < m || from > n - m) return n;
+    auto L = run_.size();
+    if (L == 0) {
+      for (auto k = from; k + m <= n; ++k)
+        if (_verify(s + k)) return k;
+      return n;
+    }
+    // 片段在文本中的起点i, 对应模式起点i - run_st_
+    auto tail = run_[L - 1];
+    for (auto i = from + run_st_; i <= n - m + run_st_;) {
+      auto c = s[i + L - 1];
+      if (c == tail && _verify(s + i - run_st_)) return i - run_st_;
+      i += shift_[c];
+    }
+    return n;
+  }
+
+ private:
+  bool valid_ = false;
+  std::vector<std::bitset<256>> sets_;  // 每个位置接受的字节
+
+  // SIMD验证: (byte & and_[i]) == eq_[i]. 长度补齐到16的倍数
+  std::vector<unsigned char> and_;
+  std::vector<unsigned char> eq_;
+  std::vector<std::size_t> slow_;  // 不能写成and/eq的位置
+
+  // 最长字面量片段的Horspool表
+  std::size_t run_st_ = 0;
+  std::vector<unsigned char> run_;
+  std::array<std::size_t, 256> shift_;
+};
+}  // namespace wzj
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Boyer_Moore.hpp"
+
+namespace wzj {
+
+// compact_boyer_moore的表格. 不可修改, 在多个searcher之间共享.
+// bad_char和good_char放在同一个数组中: [0, 256)是bad_char, [256, 256+pat_len)是good_char.
+// 最大的移动距离是good_char[0] = period + pat_len - 1 <= 2*pat_len - 1,
+// 按它选择能放下的最窄的整数类型, 只有对应宽度的数组非空
+struct bm_compact_tables {
+  template <typename _It>
+  bm_compact_tables(_It pat, std::ptrdiff_t pat_len) {
+    std::vector<std::ptrdiff_t> good(pat_len);
+    bm_detail::make_good_suffix(pat, pat_len, good);
+    auto max_shift = std::max<std::ptrdiff_t>(2 * pat_len - 1, pat_len);
+    if (max_shift <= UINT8_MAX) {
+      fill(t8_, pat, pat_len, good);
+    } else if (max_shift <= UINT16_MAX) {
+      fill(t16_, pat, pat_len, good);
+    } else {
+      fill(t32_, pat, pat_len, good);
+    }
+  }
+
+  // 每个表项的字节数
+  std::size_t width() const { return !t8_.empty() ? 1 : (!t16_.empty() ? 2 : 4); }
+  std::size_t bytes() const { return t8_.size() + 2 * t16_.size() + 4 * t32_.size(); }
+
+  std::vector<std::uint8_t> t8_;
+  std::vector<std::uint16_t> t16_;
+  std::vector<std::uint32_t> t32_;
+
+ private:
+  template <typename _T, typename _It>
+  static void fill(std::vector<_T>& t, _It pat, std::ptrdiff_t pat_len,
+                   const std::vector<std::ptrdiff_t>& good) {
+    t.assign(256 + pat_len, static_cast<_T>(pat_len));
+    for (std::ptrdiff_t i = 0; i < pat_len; ++i)
+      t[static_cast<unsigned char>(pat[i])] = static_cast<_T>(pat_len - 1 - i);
+    for (std::ptrdiff_t i = 0; i < pat_len; ++i) t[256 + i] = static_cast<_T>(good[i]);
+  }
+};
+
+// 按模式内容缓存表格. 相同模式的searcher共享同一份表格. 线程安全
+class bm_table_cache {
+ public:
+  template <typename _It>
+  std::shared_ptr<const bm_compact_tables> get(_It first, _It last) {
+    std::string key(first, last);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = cache_[key];
+    auto tables = slot.lock();
+    if (!tables) {
+      tables = std::make_shared<const bm_compact_tables>(key.begin(), key.end() - key.begin());
+      slot = tables;
+    }
+    // 清理已经没有searcher使用的表格
+    if (cache_.size() > 2 * live_ + 64) {
+      for (auto it = cache_.begin(); it != cache_.end();)
+        it = it->second.expired() ? cache_.erase(it) : std::next(it);
+      live_ = cache_.size();
+    }
+    return tables;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::weak_ptr<const bm_compact_tables>> cache_;
+  std::size_t live_ = 0;
+};
+
+// 内存紧凑的boyer_moore, 适合同时存在大量searcher的情况.
+// 1. 表格项用能放下移动距离的最窄整数类型(uint8/uint16/uint32). 长度10的模式只需要266字节
+// 2. 表格不可修改, 拷贝searcher或者通过bm_table_cache构造时共享同一份表格
+// 3. 只支持单字节元素. 结果和boyer_moore相同
+template <typename _It>
+class compact_boyer_moore {
+ public:
+  using _diff_type = typename std::iterator_traits<_It>::difference_type;
+
+ public:
+  compact_boyer_moore(_It first, _It last)
+      : tables_(std::make_shared<const bm_compact_tables>(first, last - first)),
+        st_(first),
+        en_(last) {
+    static_assert(sizeof(typename std::iterator_traits<_It>::value_type) == 1,
+                  "compact_boyer_moore only supports byte patterns");
+  }
+  // 从cache中取得(或创建)相同模式的表格
+  compact_boyer_moore(_It first, _It last, bm_table_cache& cache)
+      : tables_(cache.get(first, last)), st_(first), en_(last) {}
+
+  // 返回第一次匹配的区间. 如果不匹配, 则返回(last,last)
+  template <typename _TargetIt>
+  std::pair<_TargetIt, _TargetIt> operator()(_TargetIt first, _TargetIt last) const {
+    if (en_ == st_) return std::make_pair(first, first);
+    if (!tables_->t8_.empty()) return _search(tables_->t8_.data(), first, last);
+    if (!tables_->t16_.empty()) return _search(tables_->t16_.data(), first, last);
+    return _search(tables_->t32_.data(), first, last);
+  }
+
+  _diff_type size() const { return en_ - st_; }
+  const std::shared_ptr<const bm_compact_tables>& tables() const { return tables_; }
+
+ private:
+  // 同boyer_moore的跳跃循环, bad = t[0, 256), good = t[256, ...)
+  template <typename _T, typename _TargetIt>
+  std::pair<_TargetIt, _TargetIt> _search(const _T* t, _TargetIt first, _TargetIt last) const {
+    _diff_type pat_len = en_ - st_;
+    const _T* good = t + 256;
+    _diff_type i = pat_len - 1;
+    auto stringlen = last - first;
+    while (i < stringlen) {
+      _diff_type j = pat_len - 1;
+      while (j >= 0 && first[i] == st_[j]) {
+        --i;
+        --j;
+      }
+      if (j < 0) {
+        // match
+        const auto match = first + i + 1;
+        return std::make_pair(match, match + pat_len);
+      }
+      // not match, jump
+      _diff_type bad = t[static_cast<unsigned char>(first[i])];
+      i += std::max<_diff_type>(bad, good[j]);
+    }
+    return std::make_pair(last, last);
+  }
+
+ private:
+  std::shared_ptr<const bm_compact_tables> tables_;
+  _It st_;  // start of pattern
+  _It en_;  // end of pattern
+};
+}  // namespace wzj
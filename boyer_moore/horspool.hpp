@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+#include "Boyer_Moore.hpp"
+
+namespace wzj {
+
+// Boyer-Moore-Horspool. 只用窗口最后一个字符的bad character表跳跃, 没有good suffix表.
+// 预处理比boyer_moore少, 在字母表较大的文本上和boyer_moore一样快
+template <typename _It, typename _BadChar = typename bm_default_bad_char<_It>::type>
+class horspool {
+ public:
+  using _diff_type = typename std::iterator_traits<_It>::difference_type;
+
+ public:
+  horspool(_It first, _It last) : st_(first), en_(last) {
+    // 对pat[0, pat_len-1)建表, 得到的距离比Horspool的移动距离少1, 见operator()
+    auto pat_len = last - first;
+    bad_char_.build(first, pat_len > 0 ? pat_len - 1 : 0);
+  }
+
+  // 返回第一次匹配的区间. 如果不匹配, 则返回(last,last)
+  template <typename _TargetIt>
+  std::pair<_TargetIt, _TargetIt> operator()(_TargetIt first, _TargetIt last) const {
+    auto pat_len = en_ - st_;
+    if (pat_len == 0) return std::make_pair(first, first);
+
+    auto tail = st_[pat_len - 1];
+    _diff_type i = 0;  // 窗口起点
+    auto stringlen = last - first;
+    while (i + pat_len <= stringlen) {
+      const auto& c = first[i + pat_len - 1];
+      if (c == tail) {
+        _diff_type j = pat_len - 2;
+        while (j >= 0 && first[i + j] == st_[j]) --j;
+        if (j < 0) return std::make_pair(first + i, first + i + pat_len);
+      }
+      i += bad_char_(c) + 1;
+    }
+    return std::make_pair(last, last);
+  }
+
+  _diff_type size() const { return en_ - st_; }
+
+ private:
+  _BadChar bad_char_;
+  _It st_;  // start of pattern
+  _It en_;  // end of pattern
+};
+}  // namespace wzj
@@ -0,0 +1,33 @@
+#include <boyer_moore/mapped_file.h>
+
+#include <boyer_moore/Boyer_Moore.hpp>
+
+namespace wzj {
+
+bool search_file(const std::string& path, const std::string& pattern,
+                 std::vector<std::size_t>& offsets, bool first_only) {
+  mapped_file file;
+  if (!file.open(path)) return false;
+  if (pattern.empty() || file.size() < pattern.size()) return true;
+
+  auto bm = boyer_moore<std::string::const_iterator>(pattern.begin(), pattern.end());
+  if (first_only) {
+    auto r = bm(file.begin(), file.end());
+    if (r.first != file.end()) offsets.push_back(r.first - file.begin());
+  } else if (static_cast<std::ptrdiff_t>(pattern.size()) <= bm.simd_max_pattern_) {
+    // 短模式: 反复调用operator()走SIMD过滤, 从上一个匹配的下一个位置继续, 保留重叠的匹配
+    for (auto st = file.begin();;) {
+      auto r = bm(st, file.end());
+      if (r.first == file.end()) break;
+      offsets.push_back(r.first - file.begin());
+      st = r.first + 1;
+    }
+  } else {
+    // 长模式: 跳跃循环, Galil规则保证线性
+    bm.for_each_match(file.begin(), file.end(), [&](const char* st, const char*) {
+      offsets.push_back(st - file.begin());
+    });
+  }
+  return true;
+}
+}  // namespace wzj
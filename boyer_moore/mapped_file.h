@@ -0,0 +1,16 @@
+#pragma once
+
+#include <util/mapped_file.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace wzj {
+
+// 用wzj::boyer_moore搜索文件path中的pattern, 把匹配的起始偏移追加到offsets.
+// 不超过boyer_moore::simd_max_pattern_的模式使用SIMD首尾字节过滤, 包括查找所有匹配.
+// first_only==true时只找第一个匹配. 文件无法打开时返回false
+bool search_file(const std::string& path, const std::string& pattern,
+                 std::vector<std::size_t>& offsets, bool first_only = false);
+}  // namespace wzj
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Boyer_Moore.hpp"
+
+namespace wzj {
+namespace bm_detail {
+// 把长度为n的文本分成若干块, 块[u*block, (u+1)*block)负责起点在其中的匹配.
+// 实际搜索范围向后多取pat_len-1个元素, 这样跨块的匹配也能在它起点所在的块中找到
+struct parallel_plan {
+  parallel_plan(std::ptrdiff_t n, unsigned threads) : n_(n) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    // 每个线程分到多块, 找到第一个匹配后, 它之后的块就不用再搜索了
+    block_ = std::max<std::ptrdiff_t>(n / (static_cast<std::ptrdiff_t>(threads) * 8), min_block_);
+    units_ = static_cast<std::size_t>((n + block_ - 1) / block_);
+    threads_ = static_cast<unsigned>(std::min<std::size_t>(threads, units_));
+  }
+
+  // 多个线程依次领取块, 对每块调用work(u, st, en, search_en). 主线程也参与
+  template <typename _Work>
+  void run(_Work work, std::ptrdiff_t pat_len) const {
+    std::atomic<std::size_t> next(0);
+    auto loop = [&]() {
+      for (std::size_t u; (u = next.fetch_add(1)) < units_;) {
+        auto st = static_cast<std::ptrdiff_t>(u) * block_;
+        auto en = std::min(st + block_, n_);
+        if (!work(u, st, en, std::min(en + pat_len - 1, n_))) break;
+      }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads_; ++t) pool.emplace_back(loop);
+    loop();
+    for (auto& th : pool) th.join();
+  }
+
+  static constexpr std::ptrdiff_t min_block_ = 1 << 16;
+  std::ptrdiff_t n_;
+  std::ptrdiff_t block_;
+  std::size_t units_;
+  unsigned threads_;
+};
+}  // namespace bm_detail
+
+// 多线程查找第一个匹配, 结果和bm(first, last)相同. threads==0表示使用所有核.
+// 找到匹配后, 其他线程不再领取后面的块
+template <typename _It, typename _BadChar, typename _TargetIt>
+std::pair<_TargetIt, _TargetIt> parallel_search(const boyer_moore<_It, _BadChar>& bm, _TargetIt first,
+                                                _TargetIt last, unsigned threads = 0) {
+  auto n = last - first;
+  auto pat_len = bm.size();
+  bm_detail::parallel_plan plan(n, threads);
+  if (plan.threads_ <= 1 || pat_len == 0) return bm(first, last);
+
+  std::vector<std::ptrdiff_t> pos(plan.units_, -1);
+  std::atomic<std::size_t> best(plan.units_);  // 找到匹配的最小块
+  plan.run(
+      [&](std::size_t u, std::ptrdiff_t st, std::ptrdiff_t en, std::ptrdiff_t search_en) {
+        // 块是按顺序领取的, 之后的块都在best后面
+        if (u > best.load()) return false;
+        auto r = bm(first + st, first + search_en);
+        if (r.first != first + search_en && r.first - first < en) {
+          pos[u] = r.first - first;
+          auto b = best.load();
+          while (u < b && !best.compare_exchange_weak(b, u))
+            ;
+          return false;
+        }
+        return true;
+      },
+      pat_len);
+
+  if (best.load() == plan.units_) return std::make_pair(last, last);
+  auto match = first + pos[best.load()];
+  return std::make_pair(match, match + pat_len);
+}
+
+// 多线程查找所有(可重叠的)匹配, 按位置升序返回. 结果和bm.find_all(first, last)相同
+template <typename _It, typename _BadChar, typename _TargetIt>
+std::vector<std::pair<_TargetIt, _TargetIt>> parallel_find_all(const boyer_moore<_It, _BadChar>& bm,
+                                                               _TargetIt first, _TargetIt last,
+                                                               unsigned threads = 0) {
+  auto n = last - first;
+  auto pat_len = bm.size();
+  bm_detail::parallel_plan plan(n, threads);
+  if (plan.threads_ <= 1 || pat_len == 0) return bm.find_all(first, last);
+
+  std::vector<std::vector<std::pair<_TargetIt, _TargetIt>>> parts(plan.units_);
+  plan.run(
+      [&](std::size_t u, std::ptrdiff_t st, std::ptrdiff_t en, std::ptrdiff_t search_en) {
+        auto& part = parts[u];
+        bm.for_each_match(first + st, first + search_en, [&](_TargetIt ms, _TargetIt me) {
+          if (ms - first < en) part.emplace_back(ms, me);
+        });
+        return true;
+      },
+      pat_len);
+
+  std::vector<std::pair<_TargetIt, _TargetIt>> ans;
+  for (auto& part : parts) ans.insert(ans.end(), part.begin(), part.end());
+  return ans;
+}
+}  // namespace wzj
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <iterator>
+#include <utility>
+
+#include "Boyer_Moore.hpp"
+
+namespace wzj {
+
+// 查找最后一次匹配. 对反转的模式建表, 从last开始向左扫描反转的文本,
+// 代价和boyer_moore查找第一次匹配相同, 不需要扫描整个文本.
+// 文本是反向迭代器, 不会使用SIMD/memchr
+template <typename _It>
+class reverse_boyer_moore {
+ public:
+  using _diff_type = typename std::iterator_traits<_It>::difference_type;
+  using _rev_it = std::reverse_iterator<_It>;
+
+ public:
+  reverse_boyer_moore(_It first, _It last) : bm_(_rev_it(last), _rev_it(first)) {}
+
+  // 返回最后一次匹配的区间. 如果不匹配, 则返回(last,last)
+  template <typename _TargetIt>
+  std::pair<_TargetIt, _TargetIt> operator()(_TargetIt first, _TargetIt last) const {
+    if (bm_.size() == 0) return std::make_pair(last, last);
+    std::reverse_iterator<_TargetIt> rfirst(last), rlast(first);
+    auto r = bm_(rfirst, rlast);
+    if (r.first == rlast) return std::make_pair(last, last);
+    // 反向区间[r.first, r.second)对应正向区间[r.second.base(), r.first.base())
+    return std::make_pair(r.second.base(), r.first.base());
+  }
+
+  // 从右往左对每个匹配调用fn(first, last). overlap的含义同boyer_moore::for_each_match
+  template <typename _TargetIt, typename _Fn>
+  void for_each_match(_TargetIt first, _TargetIt last, _Fn fn, bool overlap = true) const {
+    using _rev_target = std::reverse_iterator<_TargetIt>;
+    bm_.for_each_match(
+        _rev_target(last), _rev_target(first),
+        [&fn](_rev_target st, _rev_target en) { fn(en.base(), st.base()); }, overlap);
+  }
+
+  _diff_type size() const { return bm_.size(); }
+
+ private:
+  boyer_moore<_rev_it> bm_;
+};
+}  // namespace wzj
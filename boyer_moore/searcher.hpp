@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Boyer_Moore.hpp"
+#include "horspool.hpp"
+#include "two_way.hpp"
+
+namespace wzj {
+
+// searcher选择的算法
+enum class search_engine {
+  naive,        // 逐个位置比较, 不需要预处理. 用于很短的文本
+  memchr,       // 单字节模式
+  simd,         // 短的字节模式, SIMD比较首尾字节, 见bm_detail::find_head_tail
+  horspool,     // 只有bad character表
+  boyer_moore,  // bad character + good suffix表
+  two_way,      // Crochemore-Perrin, 最坏情况线性, 不需要表格
+};
+
+// 根据模式长度, 字母表大小和文本长度选择最快的算法. 接口和boyer_moore相同.
+// 1. 只建立所选算法需要的表格
+// 2. memchr/simd要求文本是连续的字节. 其他文本退化成naive
+// 3. linear == true时(模式或文本不可信), 本来会用horspool/boyer_moore的模式改用two_way,
+//    保证O(n + m)的最坏情况和O(1)的额外内存. naive和simd只用于有界的文本/模式长度
+template <typename _It>
+class searcher {
+ public:
+  using _diff_type = typename std::iterator_traits<_It>::difference_type;
+  using _value_type = typename std::iterator_traits<_It>::value_type;
+
+  // 文本不超过该长度时, 建表的代价超过搜索本身
+  static constexpr _diff_type naive_max_text_ = 64;
+  // 模式中不同字符不超过该个数时(例如DNA), bad character表的移动距离很短, 需要good suffix表
+  static constexpr std::size_t small_alphabet_ = 4;
+  // 模式不短于该长度时, good suffix表的收益超过它的预处理代价
+  static constexpr _diff_type long_pattern_ = 256;
+
+ public:
+  // text_len_hint是预计的文本长度, -1表示未知
+  searcher(_It first, _It last, _diff_type text_len_hint = -1, bool linear = false)
+      : engine_(choose(first, last, text_len_hint, linear)), st_(first), en_(last) {
+    if (engine_ == search_engine::horspool)
+      horspool_ = std::make_shared<const horspool<_It>>(first, last);
+    else if (engine_ == search_engine::boyer_moore)
+      bm_ = std::make_shared<const boyer_moore<_It>>(first, last);
+    else if (engine_ == search_engine::two_way)
+      two_way_ = std::make_shared<const two_way<_It>>(first, last);
+  }
+
+  // 返回第一次匹配的区间. 如果不匹配, 则返回(last,last)
+  template <typename _TargetIt>
+  std::pair<_TargetIt, _TargetIt> operator()(_TargetIt first, _TargetIt last) const {
+    switch (engine_) {
+      case search_engine::memchr:
+      case search_engine::simd:
+        return _search_bytes(first, last, bm_detail::is_contiguous_byte_iter<_TargetIt>());
+      case search_engine::horspool:
+        return (*horspool_)(first, last);
+      case search_engine::boyer_moore:
+        return (*bm_)(first, last);
+      case search_engine::two_way:
+        return (*two_way_)(first, last);
+      default:
+        return _naive(first, last);
+    }
+  }
+
+  search_engine engine() const { return engine_; }
+  _diff_type size() const { return en_ - st_; }
+
+  // 选择算法. 只看模式和预计的文本长度
+  static search_engine choose(_It first, _It last, _diff_type text_len_hint = -1,
+                              bool linear = false) {
+    auto pat_len = last - first;
+    if (pat_len == 0 || (text_len_hint >= 0 && text_len_hint <= naive_max_text_))
+      return search_engine::naive;
+    if (sizeof(_value_type) == 1) {
+      if (pat_len == 1) return search_engine::memchr;
+      if (pat_len <= boyer_moore<_It>::simd_max_pattern_) return search_engine::simd;
+    }
+    if (linear) return search_engine::two_way;
+    if (pat_len >= long_pattern_ || alphabet_size(first, last) <= small_alphabet_)
+      return search_engine::boyer_moore;
+    return search_engine::horspool;
+  }
+
+ private:
+  // 模式中不同字符的个数, 超过small_alphabet_就不再统计
+  static std::size_t alphabet_size(_It first, _It last) {
+    std::vector<_value_type> seen;
+    for (auto it = first; it != last && seen.size() <= small_alphabet_; ++it)
+      if (std::find(seen.begin(), seen.end(), *it) == seen.end()) seen.push_back(*it);
+    return seen.size();
+  }
+
+  template <typename _TargetIt>
+  std::pair<_TargetIt, _TargetIt> _search_bytes(_TargetIt first, _TargetIt last,
+                                                std::true_type) const {
+    auto pat_len = en_ - st_;
+    if (last - first < pat_len) return std::make_pair(last, last);
+    auto s = reinterpret_cast<const unsigned char*>(&*first);
+    auto n = static_cast<std::size_t>(last - first);
+    // memchr和simd的区别只在模式长度, 见bm_detail::find_bytes
+    auto k = bm_detail::find_bytes(s, n, st_, static_cast<std::size_t>(pat_len));
+    if (k == n) return std::make_pair(last, last);
+    return std::make_pair(first + k, first + k + pat_len);
+  }
+  template <typename _TargetIt>
+  std::pair<_TargetIt, _TargetIt> _search_bytes(_TargetIt first, _TargetIt last,
+                                                std::false_type) const {
+    return _naive(first, last);
+  }
+
+  template <typename _TargetIt>
+  std::pair<_TargetIt, _TargetIt> _naive(_TargetIt first, _TargetIt last) const {
+    auto pat_len = en_ - st_;
+    auto it = std::search(first, last, st_, en_);
+    if (it == last) return std::make_pair(last, last);
+    return std::make_pair(it, it + pat_len);
+  }
+
+ private:
+  search_engine engine_;
+  std::shared_ptr<const horspool<_It>> horspool_;
+  std::shared_ptr<const boyer_moore<_It>> bm_;
+  std::shared_ptr<const two_way<_It>> two_way_;
+  _It st_;  // start of pattern
+  _It en_;  // end of pattern
+};
+
+// 一次性搜索. 文本长度已知, 短文本不会建表
+template <typename _TargetIt, typename _It>
+std::pair<_TargetIt, _TargetIt> search(_TargetIt first, _TargetIt last, _It pat_first,
+                                       _It pat_last) {
+  return searcher<_It>(pat_first, pat_last, last - first)(first, last);
+}
+}  // namespace wzj
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+namespace wzj {
+
+// 模式在编译期已知的boyer_moore. 需要C++17
+// 1. 模式长度_N是模板参数, 表格是std::array, 没有堆分配
+// 2. 构造函数是constexpr, 用constexpr变量保存时, 表格在编译期算好
+// 3. 只支持单字节字符
+//
+// constexpr wzj::static_boyer_moore bm("needle");
+// auto it = bm(target.begin(), target.end());
+template <typename _CharT, std::size_t _N>
+class static_boyer_moore {
+ public:
+  using _diff_type = std::ptrdiff_t;
+
+ public:
+  // pat是字符串字面量, 最后的'\0'不属于模式
+  constexpr explicit static_boyer_moore(const _CharT (&pat)[_N + 1]) {
+    static_assert(sizeof(_CharT) == 1, "static_boyer_moore only supports byte characters");
+    for (std::size_t i = 0; i < _N; ++i) pat_[i] = pat[i];
+    make_delta1();
+    make_delta2();
+  }
+
+  // 返回第一次匹配的区间. 如果不匹配, 则返回(last,last)
+  template <typename _TargetIt>
+  constexpr std::pair<_TargetIt, _TargetIt> operator()(_TargetIt first, _TargetIt last) const {
+    constexpr _diff_type pat_len = _N;
+    if (pat_len == 0) return std::make_pair(first, first);
+
+    _diff_type i = pat_len - 1;
+    auto stringlen = last - first;
+    while (i < stringlen) {
+      _diff_type j = pat_len - 1;
+      while (j >= 0 && first[i] == pat_[j]) {
+        --i;
+        --j;
+      }
+      if (j < 0) {
+        // match
+        const auto match = first + i + 1;
+        return std::make_pair(match, match + pat_len);
+      }
+      // not match, jump
+      auto bad = bad_char_[static_cast<unsigned char>(first[i])];
+      i += bad > good_char_[j] ? bad : good_char_[j];
+    }
+    return std::make_pair(last, last);
+  }
+
+  static constexpr std::size_t size() { return _N; }
+  constexpr const std::array<_CharT, _N>& pattern() const { return pat_; }
+
+ private:
+  // 以下同boyer_moore中的同名函数
+  constexpr bool is_prefix(_diff_type pos) const {
+    _diff_type suffixlen = _N - pos;
+    for (_diff_type i = 0; i < suffixlen; ++i)
+      if (pat_[i] != pat_[pos + i]) return false;
+    return true;
+  }
+  constexpr _diff_type suffix_length(_diff_type pos) const {
+    _diff_type i = 0;
+    for (; pat_[pos - i] == pat_[_N - 1 - i] && i < pos; ++i)
+      ;
+    return i;
+  }
+
+  constexpr void make_delta1() {
+    for (auto& x : bad_char_) x = _N;
+    for (std::size_t i = 0; i < _N; ++i)
+      bad_char_[static_cast<unsigned char>(pat_[i])] = _N - 1 - i;
+  }
+
+  constexpr void make_delta2() {
+    constexpr _diff_type pat_len = _N;
+    if (pat_len == 0) return;
+    _diff_type last_prefix_index = 1;
+    for (_diff_type i = pat_len - 1; i >= 0; --i) {
+      if (is_prefix(i + 1)) last_prefix_index = i + 1;
+      good_char_[i] = last_prefix_index + (pat_len - 1 - i);
+    }
+    for (_diff_type i = 0; i < pat_len - 1; ++i) {
+      auto slen = suffix_length(i);
+      auto pos = pat_len - 1 - slen;
+      if (pat_[i - slen] != pat_[pos]) good_char_[pos] = pat_len - 1 - i + slen;
+    }
+  }
+
+ private:
+  std::array<_CharT, _N> pat_{};
+  std::array<_diff_type, 256> bad_char_{};
+  std::array<_diff_type, _N> good_char_{};
+};
+
+// 从字符串字面量推导: static_boyer_moore("abc")是static_boyer_moore<char, 3>
+template <typename _CharT, std::size_t _M>
+static_boyer_moore(const _CharT (&)[_M]) -> static_boyer_moore<_CharT, _M - 1>;
+}  // namespace wzj
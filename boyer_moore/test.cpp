@@ -1,13 +1,31 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
 #include <functional>
 #include <iomanip>
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <vector>
 
 #include "Boyer_Moore.hpp"
+#include "aho_corasick.hpp"
+#include "boyer_moore_stream.hpp"
+#include "parallel_search.hpp"
+#include "mapped_file.h"
+#include "static_boyer_moore.hpp"
+#include "compact_boyer_moore.hpp"
+#include "horspool.hpp"
+#include "reverse_boyer_moore.hpp"
+#include "searcher.hpp"
+#include "two_way.hpp"
+#include "batch_search.hpp"
+#include "approximate_search.hpp"
+#include "byte_class_pattern.hpp"
 
 using namespace std::chrono;
 typedef std::chrono::milliseconds MS;
@@ -21,7 +39,579 @@ void print_info(const std::string& group, const std::vector<MS>& data) {
             << tot * 1.0 / data.size() << std::endl;
 }
 
+// 逐个位置暴力比较, 作为多模式匹配的参照
+void test_aho_corasick() {
+  for (int epoch = 0; epoch < 50; ++epoch) {
+    int sigma = epoch % 3 ? 3 : 26;  // 字母表大小
+    std::string target;
+    for (int i = 0; i < 2000; ++i) target += static_cast<char>('a' + rand() % sigma);
+    std::vector<std::string> patterns;
+    for (int i = 0; i < 20; ++i) {
+      std::string p;
+      // 偶数轮最短模式长度>=3, 会用到跳跃前端
+      int len = epoch % 2 ? 1 + rand() % 3 : 3 + rand() % 4;
+      for (int j = 0; j < len; ++j) p += static_cast<char>('a' + rand() % sigma);
+      patterns.push_back(p);
+    }
+    patterns.push_back("");
+    if (epoch % 2) patterns.push_back(patterns[0]);  // 重复的模式
+
+    std::vector<std::pair<std::string::const_iterator, std::string::const_iterator>> ranges;
+    for (auto& p : patterns) ranges.emplace_back(p.begin(), p.end());
+    wzj::aho_corasick<std::string::const_iterator> ac(ranges);
+
+    std::vector<std::tuple<size_t, size_t, size_t>> expect, got;
+    for (size_t i = 0; i < target.size(); ++i)
+      for (size_t id = 0; id < patterns.size(); ++id) {
+        auto& p = patterns[id];
+        if (!p.empty() && target.compare(i, p.size(), p) == 0)
+          expect.emplace_back(id, i, i + p.size());
+      }
+    auto base = target.cbegin();
+    for (auto& m : ac(target.cbegin(), target.cend()))
+      got.emplace_back(std::get<0>(m), std::get<1>(m) - base, std::get<2>(m) - base);
+    // 结束位置升序
+    for (size_t i = 1; i < got.size(); ++i) assert(std::get<2>(got[i - 1]) <= std::get<2>(got[i]));
+    std::sort(expect.begin(), expect.end());
+    std::sort(got.begin(), got.end());
+    assert(expect == got);
+  }
+}
+
+// 覆盖memchr, SIMD过滤和跳跃三条路径, 以及向量末尾不足一个块的部分
+void test_byte_search_paths() {
+  for (int epoch = 0; epoch < 200; ++epoch) {
+    std::string target;
+    int n = rand() % 300;
+    for (int i = 0; i < n; ++i) target += static_cast<char>('0' + rand() % 4);
+    std::string pattern;
+    int m = 1 + epoch % 40;
+    for (int i = 0; i < m; ++i) pattern += static_cast<char>('0' + rand() % 4);
+    if (epoch % 3 == 0 && n > m) {  // 保证有匹配
+      auto pos = rand() % (n - m);
+      target.replace(pos, m, pattern);
+    }
+
+    auto expect = std::search(target.begin(), target.end(), pattern.begin(), pattern.end());
+    auto bm = wzj::boyer_moore<std::string::iterator>(pattern.begin(), pattern.end());
+    assert(bm(target.begin(), target.end()).first == expect);
+    // 非连续迭代器走原来的跳跃循环
+    std::deque<char> d(target.begin(), target.end());
+    auto r = bm(d.cbegin(), d.cend());
+    assert(r.first - d.cbegin() == expect - target.begin());
+  }
+  // 大于127的字节
+  std::vector<unsigned char> data = {0x10, 0xff, 0x80, 0xfe, 0xff, 0x80, 0x01};
+  std::vector<unsigned char> pat = {0xff, 0x80, 0x01};
+  auto bm = wzj::boyer_moore<std::vector<unsigned char>::iterator>(pat.begin(), pat.end());
+  assert(bm(data.data(), data.data() + data.size()).first == data.data() + 4);
+}
+
+// 把文本切成随机长度的块输入, 结果应和整体搜索相同
+void test_stream() {
+  for (int epoch = 0; epoch < 100; ++epoch) {
+    std::string target;
+    for (int i = 0; i < 1000; ++i) target += static_cast<char>('a' + rand() % 2);
+    std::string pattern;
+    int m = 1 + epoch % 8;
+    for (int i = 0; i < m; ++i) pattern += static_cast<char>('a' + rand() % 2);
+
+    std::vector<long> expect, got;
+    for (auto it = target.begin();
+         (it = std::search(it, target.end(), pattern.begin(), pattern.end())) != target.end(); ++it)
+      expect.push_back(it - target.begin());
+
+    wzj::boyer_moore_stream<std::string::iterator> bms(pattern.begin(), pattern.end());
+    size_t pos = 0;
+    while (pos < target.size()) {
+      size_t len = std::min<size_t>(target.size() - pos, rand() % 12);  // 可能是空块, 可能比模式短
+      bms.feed(target.data() + pos, target.data() + pos + len, [&](long off) { got.push_back(off); });
+      pos += len;
+    }
+    assert(bms.consumed() == static_cast<long>(target.size()));
+    assert(expect == got);
+  }
+}
+
+void test_find_all() {
+  for (int epoch = 0; epoch < 200; ++epoch) {
+    std::string target;
+    for (int i = 0; i < 500; ++i) target += static_cast<char>('a' + rand() % 2);
+    std::string pattern;
+    int m = 1 + epoch % 6;
+    for (int i = 0; i < m; ++i) pattern += static_cast<char>('a' + rand() % 2);
+
+    std::vector<long> overlap, disjoint;
+    for (size_t i = 0; i + m <= target.size(); ++i)
+      if (target.compare(i, m, pattern) == 0) {
+        overlap.push_back(i);
+        if (disjoint.empty() || disjoint.back() + m <= static_cast<long>(i)) disjoint.push_back(i);
+      }
+
+    auto bm = wzj::boyer_moore<std::string::iterator>(pattern.begin(), pattern.end());
+    std::vector<long> got;
+    for (auto& r : bm.find_all(target.begin(), target.end())) got.push_back(r.first - target.begin());
+    assert(got == overlap);
+    got.clear();
+    for (auto& r : bm.find_all(target.begin(), target.end(), false)) got.push_back(r.first - target.begin());
+    assert(got == disjoint);
+  }
+  // 周期模式. 不使用Galil规则时是O(n*m)
+  std::string target(1000000, 'a'), pattern(1000, 'a');
+  auto bm = wzj::boyer_moore<std::string::iterator>(pattern.begin(), pattern.end());
+  size_t cnt = 0;
+  bm.for_each_match(target.begin(), target.end(), [&cnt](std::string::iterator, std::string::iterator) { ++cnt; });
+  assert(cnt == target.size() - pattern.size() + 1);
+
+  // O(n + k): 用bm_search_stats统计字符比较次数, 周期模式上也不超过2n
+  using It = std::string::const_iterator;
+  using stats_bm = wzj::boyer_moore<It, wzj::bm_default_bad_char<It>::type, wzj::bm_search_stats>;
+  for (const std::string& p : {std::string("aaaa"), pattern, std::string("abaabaab")}) {
+    std::string text = p == "abaabaab" ? std::string() : target;
+    for (size_t i = 0; text.size() < target.size(); ++i) text += "aba"[i % 3];
+    stats_bm sbm(p.cbegin(), p.cend());
+    size_t matches = 0;
+    sbm.for_each_match(text.cbegin(), text.cend(), [&matches](It, It) { ++matches; });
+    assert(matches > 0 && sbm.stats().matches == matches);
+    assert(sbm.stats().comparisons <= 2 * text.size());
+  }
+}
+
+void test_parallel_search() {
+  // 文本要比parallel_plan::min_block_大得多, 才会真正分块
+  std::string target;
+  for (int i = 0; i < 1000000; ++i) target += static_cast<char>('0' + rand() % 10);
+  for (int m : {1, 3, 6, 12}) {
+    std::string pattern;
+    for (int i = 0; i < m; ++i) pattern += static_cast<char>('0' + rand() % 10);
+    auto bm = wzj::boyer_moore<std::string::iterator>(pattern.begin(), pattern.end());
+    for (unsigned threads : {1u, 3u, 8u}) {
+      assert(wzj::parallel_search(bm, target.begin(), target.end(), threads) ==
+             bm(target.begin(), target.end()));
+      assert(wzj::parallel_find_all(bm, target.begin(), target.end(), threads) ==
+             bm.find_all(target.begin(), target.end()));
+    }
+  }
+  // 只在靠后的位置有匹配, 跨过块的边界
+  std::string pattern(10, 'x');
+  target.replace(3 * 65536 - 4, pattern.size(), pattern);
+  auto bm = wzj::boyer_moore<std::string::iterator>(pattern.begin(), pattern.end());
+  auto r = wzj::parallel_search(bm, target.begin(), target.end(), 4);
+  assert(r.first - target.begin() == 3 * 65536 - 4);
+  assert(wzj::parallel_find_all(bm, target.begin(), target.end(), 4).size() == 1);
+}
+
+void test_mapped_file() {
+  const char* path = "test_boyer_moore_mapped_file.tmp";
+  std::string content;
+  for (int i = 0; i < 100000; ++i) content += static_cast<char>('0' + rand() % 10);
+  content += "needle";
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << content;
+  }
+  wzj::mapped_file file(path);
+  assert(file.is_open() && file.size() == content.size());
+  assert(std::string(file.begin(), file.end()) == content);
+
+  std::vector<size_t> offsets;
+  assert(wzj::search_file(path, "needle", offsets));
+  assert(offsets.size() == 1 && offsets[0] == content.size() - 6);
+  // 可以重叠的短模式(SIMD)和长模式(跳跃循环)
+  for (const std::string& pattern : {std::string("12"), std::string("11"), content.substr(500, 40)}) {
+    offsets.clear();
+    assert(wzj::search_file(path, pattern, offsets));
+    size_t cnt = 0;
+    for (size_t pos = 0; (pos = content.find(pattern, pos)) != std::string::npos; ++pos) {
+      assert(offsets[cnt] == pos);
+      ++cnt;
+    }
+    assert(cnt == offsets.size() && cnt > 0);
+  }
+  offsets.clear();
+  assert(wzj::search_file(path, "12", offsets, true) && offsets.size() == 1);
+
+  file.close();
+  std::remove(path);
+  assert(!wzj::search_file(path, "12", offsets));
+}
+
+void test_static_boyer_moore() {
+  // 编译期构造和搜索
+  constexpr wzj::static_boyer_moore bm("abcab");
+  constexpr const char text[] = "xxabcabcabyy";
+  static_assert(bm.size() == 5, "");
+  static_assert(bm(text, text + sizeof(text) - 1).first == text + 2, "");
+  static_assert(bm(text, text + 5).first == text + 5, "");
+
+  // 和boyer_moore的结果相同
+  for (int epoch = 0; epoch < 100; ++epoch) {
+    std::string target;
+    for (int i = 0; i < 1000; ++i) target += static_cast<char>('a' + rand() % 3);
+    std::string pattern = "abcab";
+    auto expect = wzj::boyer_moore<std::string::iterator>(pattern.begin(), pattern.end())(
+        target.begin(), target.end());
+    assert(bm(target.begin(), target.end()) == expect);
+  }
+  constexpr wzj::static_boyer_moore empty("");
+  static_assert(empty(text, text + 3).first == text, "");
+}
+
+// 宽字符使用哈希表作为bad_char_
+void test_wide_alphabet() {
+  for (int epoch = 0; epoch < 100; ++epoch) {
+    std::vector<uint32_t> tokens;
+    for (int i = 0; i < 2000; ++i) tokens.push_back(4000000000u - rand() % (epoch % 2 ? 4 : 1000));
+    std::vector<uint32_t> pattern(tokens.begin() + 500, tokens.begin() + 500 + 1 + epoch % 20);
+    auto bm = wzj::boyer_moore<std::vector<uint32_t>::iterator>(pattern.begin(), pattern.end());
+    auto expect = std::search(tokens.begin(), tokens.end(), pattern.begin(), pattern.end());
+    assert(bm(tokens.begin(), tokens.end()).first == expect);
+    assert(bm.find_all(tokens.begin(), tokens.end()).size() >= 1);
+  }
+  // 负数和不在模式中的字符
+  std::vector<int> data = {5, -1, -7, 3, -1, -7, -2, 9};
+  std::vector<int> pat = {-1, -7, -2};
+  auto bm = wzj::boyer_moore<std::vector<int>::iterator>(pat.begin(), pat.end());
+  assert(bm(data.begin(), data.end()).first == data.begin() + 4);
+
+  std::u32string text = U"\U0001F600ab\U0001F601\U0001F600ab\U0001F602", needle = U"\U0001F600ab\U0001F602";
+  auto bm32 = wzj::boyer_moore<std::u32string::iterator>(needle.begin(), needle.end());
+  assert(bm32(text.begin(), text.end()).first == text.begin() + 4);
+  std::u16string text16 = u"\u4e2d\u6587\u4e2d\u6587\u5b57", needle16 = u"\u6587\u5b57";
+  auto bm16 = wzj::boyer_moore<std::u16string::iterator>(needle16.begin(), needle16.end());
+  assert(bm16(text16.begin(), text16.end()).first == text16.begin() + 3);
+}
+
+void test_compact_boyer_moore() {
+  std::string target;
+  for (int i = 0; i < 200000; ++i) target += static_cast<char>('0' + rand() % 4);
+  wzj::bm_table_cache cache;
+  // 表项宽度随模式长度变化: 10 -> uint8, 200 -> uint16, 40000 -> uint32
+  for (int m : {1, 10, 127, 128, 200, 40000}) {
+    std::string pattern = target.substr(rand() % (target.size() - m), m);
+    if (m == 10) pattern[3] = 'x';  // 不匹配
+    wzj::compact_boyer_moore<std::string::const_iterator> cbm(pattern.cbegin(), pattern.cend());
+    auto bm = wzj::boyer_moore<std::string::const_iterator>(pattern.cbegin(), pattern.cend());
+    auto expect = bm(target.cbegin(), target.cend());
+    assert(cbm(target.cbegin(), target.cend()) == expect);
+    assert(cbm.tables()->width() == (m <= 128 ? 1u : (m <= 32768 ? 2u : 4u)));
+    assert(cbm.tables()->bytes() == (256 + m) * cbm.tables()->width());
+
+    // 相同内容的模式共享表格
+    std::string copy = pattern;
+    wzj::compact_boyer_moore<std::string::const_iterator> c1(pattern.cbegin(), pattern.cend(), cache);
+    wzj::compact_boyer_moore<std::string::const_iterator> c2(copy.cbegin(), copy.cend(), cache);
+    assert(c1.tables() == c2.tables());
+    assert(c2(target.cbegin(), target.cend()).first - target.cbegin() == expect.first - target.cbegin());
+    auto c3 = c1;
+    assert(c3.tables() == c1.tables());
+  }
+}
+
+void test_searcher() {
+  using It = std::string::const_iterator;
+  auto engine_of = [](const std::string& p, long hint = -1) {
+    return wzj::searcher<It>::choose(p.cbegin(), p.cend(), hint);
+  };
+  assert(engine_of("") == wzj::search_engine::naive);
+  assert(engine_of("abcdef", 10) == wzj::search_engine::naive);
+  assert(engine_of("a") == wzj::search_engine::memchr);
+  assert(engine_of("ab") == wzj::search_engine::simd);
+  assert(engine_of(std::string(40, 'a') + "b") == wzj::search_engine::boyer_moore);  // 字母表小
+  std::string letters;
+  for (int i = 0; i < 40; ++i) letters += static_cast<char>('a' + i % 26);
+  assert(engine_of(letters) == wzj::search_engine::horspool);
+  assert(engine_of(std::string(300, 'x') + letters) == wzj::search_engine::boyer_moore);  // 模式长
+  assert(wzj::searcher<It>::choose(letters.cbegin(), letters.cend(), -1, true) == wzj::search_engine::two_way);
+
+  for (int epoch = 0; epoch < 300; ++epoch) {
+    int sigma = epoch % 2 ? 4 : 26;
+    std::string target;
+    int n = epoch % 5 == 0 ? rand() % 60 : 3000;
+    for (int i = 0; i < n; ++i) target += static_cast<char>('a' + rand() % sigma);
+    std::string pattern;
+    int m = 1 + rand() % (epoch % 3 ? 40 : 400);
+    if (n > m && epoch % 4 == 0) {
+      pattern = target.substr(rand() % (n - m), m);
+    } else {
+      for (int i = 0; i < m; ++i) pattern += static_cast<char>('a' + rand() % sigma);
+    }
+
+    auto expect = std::search(target.cbegin(), target.cend(), pattern.cbegin(), pattern.cend());
+    wzj::searcher<It> sr(pattern.cbegin(), pattern.cend());
+    assert(sr(target.cbegin(), target.cend()).first == expect);
+    assert(wzj::search(target.cbegin(), target.cend(), pattern.cbegin(), pattern.cend()).first == expect);
+    auto hp = wzj::horspool<It>(pattern.cbegin(), pattern.cend());
+    assert(hp(target.cbegin(), target.cend()).first == expect);
+    // 非连续文本
+    std::deque<char> d(target.begin(), target.end());
+    assert(sr(d.cbegin(), d.cend()).first - d.cbegin() == expect - target.cbegin());
+  }
+  // 宽字符
+  std::u32string text = U"uvwxyzuvwxyzab", needle = U"vwxyzab";
+  wzj::searcher<std::u32string::iterator> sr32(needle.begin(), needle.end());
+  assert(sr32.engine() == wzj::search_engine::horspool);
+  assert(sr32(text.begin(), text.end()).first == text.begin() + 7);
+}
+
+// 随机文本和周期性文本(最坏情况), 和std::search比较第一个匹配和所有匹配
+void test_two_way() {
+  using It = std::string::const_iterator;
+  for (int epoch = 0; epoch < 400; ++epoch) {
+    std::string target, pattern;
+    if (epoch % 2) {
+      int sigma = 1 + rand() % 4;
+      for (int i = 0; i < 1000; ++i) target += static_cast<char>('a' + rand() % sigma);
+      int m = 1 + rand() % 30;
+      for (int i = 0; i < m; ++i) pattern += static_cast<char>('a' + rand() % sigma);
+    } else {
+      // 文本和模式都是同一个短串的重复, 模式末尾可能被改掉
+      std::string unit;
+      int u = 1 + rand() % 5;
+      for (int i = 0; i < u; ++i) unit += static_cast<char>('a' + rand() % 2);
+      while (target.size() < 1000) target += unit;
+      int m = 1 + rand() % 60;
+      for (int i = 0; i < m; ++i) pattern += unit[i % u];
+      if (rand() % 2) pattern.back() = 'c';
+    }
+    std::vector<long> expect, got;
+    for (auto it = target.cbegin();; ++it) {
+      it = std::search(it, target.cend(), pattern.cbegin(), pattern.cend());
+      if (it == target.cend()) break;
+      expect.push_back(it - target.cbegin());
+    }
+    wzj::two_way<It> tw(pattern.cbegin(), pattern.cend());
+    tw.for_each_match(target.cbegin(), target.cend(), [&](It st, It en) {
+      assert(en - st == tw.size());
+      got.push_back(st - target.cbegin());
+    });
+    assert(expect == got);
+    auto first = tw(target.cbegin(), target.cend()).first;
+    assert(expect.empty() ? first == target.cend() : first - target.cbegin() == expect[0]);
+    wzj::searcher<It> sr(pattern.cbegin(), pattern.cend(), -1, true);
+    assert(sr(target.cbegin(), target.cend()).first == first);
+  }
+  // 非字节元素, 空模式
+  std::u32string text = U"uvwxyzuvwxyzab", needle = U"zab";
+  wzj::two_way<std::u32string::iterator> tw32(needle.begin(), needle.end());
+  assert(tw32(text.begin(), text.end()).first == text.begin() + 11);
+  std::string empty;
+  wzj::two_way<It> tw0(empty.cbegin(), empty.cend());
+  assert(tw0(empty.cbegin(), empty.cend()).first == empty.cbegin());
+}
+
+// 带统计的searcher结果不变, 计数和实际的比较/移动一致
+void test_search_stats() {
+  using It = std::string::const_iterator;
+  using stats_bm = wzj::boyer_moore<It, wzj::bm_default_bad_char<It>::type, wzj::bm_search_stats>;
+  // 默认的bm_no_stats不占空间: 和只有bad_char_, good_char_, st_, en_的结构一样大
+  struct plain_bm {
+    wzj::bm_default_bad_char<It>::type bad_char;
+    std::vector<std::ptrdiff_t> good_char;
+    It st, en;
+  };
+  static_assert(sizeof(wzj::boyer_moore<It>) == sizeof(plain_bm), "bm_no_stats must not add padding");
+  static_assert(sizeof(stats_bm) > sizeof(plain_bm), "");
+  for (int epoch = 0; epoch < 100; ++epoch) {
+    std::string target, pattern;
+    for (int i = 0; i < 2000; ++i) target += static_cast<char>('a' + rand() % 4);
+    int m = 1 + rand() % 20;
+    for (int i = 0; i < m; ++i) pattern += static_cast<char>('a' + rand() % 4);
+
+    stats_bm bm(pattern.cbegin(), pattern.cend());
+    auto expect = std::search(target.cbegin(), target.cend(), pattern.cbegin(), pattern.cend());
+    assert(bm(target.cbegin(), target.cend()).first == expect);
+    auto& st = bm.stats();
+    // 每个窗口要么匹配, 要么移动一次; 每个窗口至少比较一个字符
+    assert(st.attempts == st.matches + st.shifts());
+    assert(st.matches == (expect != target.cend() ? 1u : 0u));
+    assert(st.comparisons >= st.attempts && st.comparisons <= st.attempts * m);
+    assert(st.bad_char_shifts[0] + st.good_char_shifts[0] <= st.shifts());
+
+    bm.stats().reset();
+    size_t calls = 0;
+    bm.stats().callback = [&calls](const wzj::bm_search_stats&) { ++calls; };
+    auto all = bm.find_all(target.cbegin(), target.cend());
+    assert(st.matches == all.size());
+    assert(calls == st.shifts());
+  }
+  // 长度为1的模式, 每次移动都是1
+  std::string target(100, 'a'), pattern = "b";
+  stats_bm bm(pattern.cbegin(), pattern.cend());
+  assert(bm(target.cbegin(), target.cend()).first == target.cend());
+  assert(bm.stats().comparisons == 100 && bm.stats().bad_char_shifts[0] == 100);
+}
+
+// 和std::find_end比较
+void test_reverse_boyer_moore() {
+  using It = std::string::const_iterator;
+  for (int epoch = 0; epoch < 300; ++epoch) {
+    std::string target, pattern;
+    int sigma = epoch % 2 ? 3 : 26;
+    for (int i = 0; i < 1500; ++i) target += static_cast<char>('a' + rand() % sigma);
+    int m = 1 + rand() % (epoch % 3 ? 8 : 60);
+    for (int i = 0; i < m; ++i) pattern += static_cast<char>('a' + rand() % sigma);
+
+    wzj::reverse_boyer_moore<It> rbm(pattern.cbegin(), pattern.cend());
+    auto expect = std::find_end(target.cbegin(), target.cend(), pattern.cbegin(), pattern.cend());
+    auto r = rbm(target.cbegin(), target.cend());
+    assert(r.first == expect);
+    assert(expect == target.cend() || r.second - r.first == m);
+
+    // 从右往左的所有匹配是正向结果的逆序
+    wzj::boyer_moore<It> bm(pattern.cbegin(), pattern.cend());
+    auto forward = bm.find_all(target.cbegin(), target.cend());
+    std::vector<std::pair<It, It>> backward;
+    rbm.for_each_match(target.cbegin(), target.cend(), [&](It st, It en) { backward.emplace_back(st, en); });
+    std::reverse(backward.begin(), backward.end());
+    assert(forward == backward);
+  }
+  std::vector<int> v = {1, 2, 3, 1, 2, 3, 1}, p = {1, 2};
+  wzj::reverse_boyer_moore<std::vector<int>::iterator> rv(p.begin(), p.end());
+  assert(rv(v.begin(), v.end()).first == v.begin() + 3);
+}
+
+void test_batch_search() {
+  std::string storage;
+  std::vector<std::pair<size_t, size_t>> spans;
+  for (int i = 0; i < 20000; ++i) {
+    int len = rand() % 40;
+    spans.emplace_back(storage.size(), len);
+    for (int j = 0; j < len; ++j) storage += static_cast<char>('a' + rand() % 4);
+  }
+  std::vector<std::string_view> records;
+  for (auto& sp : spans) records.emplace_back(storage.data() + sp.first, sp.second);
+
+  std::string pattern = "abca";
+  auto bm = wzj::boyer_moore<std::string::const_iterator>(pattern.cbegin(), pattern.cend());
+  std::vector<size_t> expect;
+  for (size_t i = 0; i < records.size(); ++i)
+    if (records[i].find(pattern) != std::string_view::npos) expect.push_back(i);
+
+  wzj::worker_pool pool(4);
+  for (auto* p : {static_cast<wzj::worker_pool*>(nullptr), &pool}) {
+    assert(wzj::batch_search_indices(bm, records.begin(), records.end(), p) == expect);
+    auto bitmap = wzj::batch_search_bitmap(bm, records.begin(), records.end(), p);
+    assert(bitmap.size() == (records.size() + 63) / 64);
+    for (auto i : expect) assert((bitmap[i / 64] >> (i % 64)) & 1);
+  }
+  // 其他searcher, 反复使用同一个pool
+  wzj::searcher<std::string::const_iterator> sr(pattern.cbegin(), pattern.cend());
+  for (int k = 0; k < 10; ++k)
+    assert(wzj::batch_search_indices(sr, records.begin(), records.end(), &pool) == expect);
+}
+
+// 和逐个位置的动态规划比较. 模式长度覆盖单字和多字(>64)
+void test_approximate_search() {
+  for (int epoch = 0; epoch < 60; ++epoch) {
+    std::string target;
+    for (int i = 0; i < 400; ++i) target += static_cast<char>('a' + rand() % 3);
+    int m = 1 + rand() % (epoch % 2 ? 10 : 150);
+    std::string pattern = target.substr(rand() % (target.size() - m), m);
+    for (int i = 0; i < 3; ++i) pattern[rand() % m] = static_cast<char>('a' + rand() % 3);
+    int k = rand() % 4 + (epoch % 2 ? 0 : m / 8);
+    int n = static_cast<int>(target.size());
+
+    // Hamming
+    std::vector<std::pair<int, int>> expect, got;
+    for (int j = m; j <= n; ++j) {
+      int d = 0;
+      for (int i = 0; i < m; ++i) d += target[j - m + i] != pattern[i];
+      if (d <= k) expect.emplace_back(j, d);
+    }
+    wzj::hamming_searcher<std::string::const_iterator> hs(pattern.cbegin(), pattern.cend(), k);
+    hs.for_each_match(target.cbegin(), target.cend(), [&](std::string::const_iterator end, int d) {
+      got.emplace_back(static_cast<int>(end - target.cbegin()), d);
+    });
+    assert(expect == got);
+    auto first = hs(target.cbegin(), target.cend());
+    assert(expect.empty() ? first.second == -1 : first.first - target.cbegin() == expect[0].first);
+
+    // 编辑距离: D[i][j], 第0行全是0
+    expect.clear();
+    got.clear();
+    std::vector<int> col(m + 1);
+    for (int i = 0; i <= m; ++i) col[i] = i;
+    for (int j = 1; j <= n; ++j) {
+      int diag = col[0];
+      col[0] = 0;
+      for (int i = 1; i <= m; ++i) {
+        int up = col[i];
+        col[i] = std::min({up + 1, col[i - 1] + 1, diag + (pattern[i - 1] != target[j - 1])});
+        diag = up;
+      }
+      if (col[m] <= k) expect.emplace_back(j, col[m]);
+    }
+    wzj::myers_searcher<std::string::const_iterator> ms(pattern.cbegin(), pattern.cend(), k);
+    ms.for_each_match(target.cbegin(), target.cend(), [&](std::string::const_iterator end, int d) {
+      got.emplace_back(static_cast<int>(end - target.cbegin()), d);
+    });
+    assert(expect == got);
+  }
+}
+
+void test_byte_class_pattern() {
+  wzj::byte_class_pattern p("id=[0-9]?;");
+  assert(p.valid() && p.size() == 6);
+  std::string text = "id=x1; id=1a; id=42;";
+  auto r = p(text.cbegin(), text.cend());
+  assert(std::string(r.first, r.second) == "id=1a;");
+  size_t cnt = 0;
+  p.for_each_match(text.cbegin(), text.cend(), [&cnt](std::string::const_iterator, std::string::const_iterator) { ++cnt; });
+  assert(cnt == 2);
+
+  assert(!wzj::byte_class_pattern("[abc").valid());
+  assert(!wzj::byte_class_pattern("ab\\").valid());
+  assert(!wzj::byte_class_pattern("[z-a]").valid());
+  assert(!wzj::byte_class_pattern("a[]b").valid() && !wzj::byte_class_pattern("[^]").valid());
+  wzj::byte_class_pattern esc("\\?[^a-y]");
+  std::string t2 = "a?b?z?{";
+  assert(esc(t2.cbegin(), t2.cend()).first == t2.cbegin() + 3);  // "?z"
+
+  // 和逐个位置检查比较. 模式长度超过16, 覆盖SIMD验证和补齐
+  const char* pieces[] = {"a", "b", "?", "[ab]", "[^a]", "[a-c]", "[0-7]", "[acd]", "ab", "ba"};
+  for (int epoch = 0; epoch < 200; ++epoch) {
+    std::string target;
+    for (int i = 0; i < 2000; ++i) target += "abcd01234567"[rand() % (epoch % 2 ? 4 : 12)];
+    std::string expr;
+    int pieces_cnt = 1 + rand() % 20;
+    for (int i = 0; i < pieces_cnt; ++i) expr += pieces[rand() % 10];
+    wzj::byte_class_pattern bp(expr);
+    assert(bp.valid());
+    auto m = bp.size();
+    std::vector<size_t> expect, got;
+    for (size_t k = 0; k + m <= target.size(); ++k) {
+      size_t i = 0;
+      while (i < m && bp.accepts(i, static_cast<unsigned char>(target[k + i]))) ++i;
+      if (i == m) expect.push_back(k);
+    }
+    bp.for_each_match(target.cbegin(), target.cend(), [&](std::string::const_iterator st, std::string::const_iterator) {
+      got.push_back(st - target.cbegin());
+    });
+    assert(expect == got);
+    auto first = bp(target.cbegin(), target.cend()).first;
+    assert(expect.empty() ? first == target.cend() : first - target.cbegin() == static_cast<long>(expect[0]));
+  }
+}
+
 int main() {
+  test_aho_corasick();
+  test_byte_class_pattern();
+  test_approximate_search();
+  test_batch_search();
+  test_two_way();
+  test_reverse_boyer_moore();
+  test_search_stats();
+  test_searcher();
+  test_compact_boyer_moore();
+  test_wide_alphabet();
+  test_static_boyer_moore();
+  test_mapped_file();
+  test_parallel_search();
+  test_find_all();
+  test_byte_search_paths();
+  test_stream();
+
   std::vector<MS> std_used;
   std::vector<MS> my_used;
 
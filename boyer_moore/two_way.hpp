@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+namespace wzj {
+
+// Two-Way字符串匹配(Crochemore-Perrin), glibc的memmem使用的算法.
+// 1. 最坏情况O(n + m)次比较, 包括找出所有匹配
+// 2. 除了几个整数外不需要额外内存, 没有表格. 元素只需要支持==和<
+// 3. 把模式在临界位置ell分成x[0, ell]和x[ell+1, m): 先从左往右比较右半部分, 再从右往左比较左半部分
+template <typename _It>
+class two_way {
+ public:
+  using _diff_type = typename std::iterator_traits<_It>::difference_type;
+
+ public:
+  two_way(_It first, _It last) : st_(first), en_(last) {
+    auto pat_len = last - first;
+    if (pat_len == 0) return;
+    // 临界分解: 两种字典序下最大后缀中靠后的那个
+    _diff_type p, q;
+    auto i = maximal_suffix(false, p);
+    auto j = maximal_suffix(true, q);
+    if (i > j) {
+      ell_ = i;
+      per_ = p;
+    } else {
+      ell_ = j;
+      per_ = q;
+    }
+    // x[0, ell]是否是x[per, per+ell]的后缀, 即模式是否以per为周期
+    periodic_ = ell_ + 1 + per_ <= pat_len && std::equal(first, first + ell_ + 1, first + per_);
+    if (!periodic_) per_ = std::max(ell_ + 1, pat_len - ell_ - 1) + 1;
+  }
+
+  // 返回第一次匹配的区间. 如果不匹配, 则返回(last,last)
+  template <typename _TargetIt>
+  std::pair<_TargetIt, _TargetIt> operator()(_TargetIt first, _TargetIt last) const {
+    auto pat_len = en_ - st_;
+    if (pat_len == 0) return std::make_pair(first, first);
+    auto ans = std::make_pair(last, last);
+    _scan(first, last, [&](_diff_type pos) {
+      ans = std::make_pair(first + pos, first + pos + pat_len);
+      return false;
+    });
+    return ans;
+  }
+
+  // 按顺序对每个(可重叠的)匹配调用fn(first, last)
+  template <typename _TargetIt, typename _Fn>
+  void for_each_match(_TargetIt first, _TargetIt last, _Fn fn) const {
+    auto pat_len = en_ - st_;
+    if (pat_len == 0) return;
+    _scan(first, last, [&](_diff_type pos) {
+      fn(first + pos, first + pos + pat_len);
+      return true;
+    });
+  }
+
+  _diff_type size() const { return en_ - st_; }
+
+ private:
+  // 返回最大后缀的起点-1, period是它的周期. invert==true时使用相反的字典序
+  _diff_type maximal_suffix(bool invert, _diff_type& period) const {
+    auto x = st_;
+    auto pat_len = en_ - st_;
+    _diff_type ms = -1, j = 0, k = 1;
+    period = 1;
+    while (j + k < pat_len) {
+      const auto& a = x[j + k];
+      const auto& b = x[ms + k];
+      if (invert ? b < a : a < b) {
+        j += k;
+        k = 1;
+        period = j - ms;
+      } else if (a == b) {
+        if (k != period) {
+          ++k;
+        } else {
+          j += period;
+          k = 1;
+        }
+      } else {
+        ms = j;
+        j = ms + 1;
+        k = period = 1;
+      }
+    }
+    return ms;
+  }
+
+  // 对每个匹配的起点调用on_match(pos), 返回false时停止
+  template <typename _TargetIt, typename _Fn>
+  void _scan(_TargetIt y, _TargetIt last, _Fn on_match) const {
+    auto x = st_;
+    auto m = en_ - st_;
+    auto n = last - y;
+    _diff_type j = 0;
+    if (periodic_) {
+      // memory: 上次匹配后, 窗口中x[0, memory]已知匹配
+      _diff_type memory = -1;
+      while (j <= n - m) {
+        auto i = std::max(ell_, memory) + 1;
+        while (i < m && x[i] == y[i + j]) ++i;
+        if (i >= m) {
+          i = ell_;
+          while (i > memory && x[i] == y[i + j]) --i;
+          if (i <= memory && !on_match(j)) return;
+          j += per_;
+          memory = m - per_ - 1;
+        } else {
+          j += i - ell_;
+          memory = -1;
+        }
+      }
+    } else {
+      while (j <= n - m) {
+        auto i = ell_ + 1;
+        while (i < m && x[i] == y[i + j]) ++i;
+        if (i >= m) {
+          i = ell_;
+          while (i >= 0 && x[i] == y[i + j]) --i;
+          if (i < 0 && !on_match(j)) return;
+          j += per_;
+        } else {
+          j += i - ell_;
+        }
+      }
+    }
+  }
+
+ private:
+  _It st_;  // start of pattern
+  _It en_;  // end of pattern
+  _diff_type ell_ = -1;    // 临界位置, 左半部分是x[0, ell_]
+  _diff_type per_ = 1;     // 周期(非周期模式时是安全的移动距离)
+  bool periodic_ = false;  // 模式是否以per_为周期
+};
+}  // namespace wzj
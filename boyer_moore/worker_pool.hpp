@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wzj {
+
+// 常驻的工作线程. 反复提交任务时不需要每次创建线程
+class worker_pool {
+ public:
+  // threads是包括调用线程在内的线程数, 0表示使用所有核
+  explicit worker_pool(unsigned threads = 0) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned t = 1; t < threads; ++t) workers_.emplace_back([this]() { _work(); });
+  }
+  ~worker_pool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& th : workers_) th.join();
+  }
+  worker_pool(const worker_pool&) = delete;
+  worker_pool& operator=(const worker_pool&) = delete;
+
+  // 对i = 0..n-1调用fn(i), 分给所有线程, 调用线程也参与. 返回时全部完成.
+  // 同一时间只能有一个parallel_for
+  void parallel_for(std::size_t n, const std::function<void(std::size_t)>& fn) {
+    if (n == 0) return;
+    if (workers_.empty() || n == 1) {
+      for (std::size_t i = 0; i < n; ++i) fn(i);
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      job_ = &fn;
+      n_ = n;
+      next_ = 0;
+      running_ = workers_.size();
+      ++generation_;
+    }
+    wake_.notify_all();
+    _run(fn, n);
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this]() { return running_ == 0; });
+    job_ = nullptr;
+  }
+
+  // 包括调用线程在内的线程数
+  unsigned size() const { return static_cast<unsigned>(workers_.size() + 1); }
+
+ private:
+  void _run(const std::function<void(std::size_t)>& fn, std::size_t n) {
+    for (std::size_t i; (i = next_.fetch_add(1)) < n;) fn(i);
+  }
+
+  void _work() {
+    std::size_t seen = 0;
+    for (;;) {
+      const std::function<void(std::size_t)>* job;
+      std::size_t n;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [&]() { return stop_ || generation_ != seen; });
+        if (stop_) return;
+        seen = generation_;
+        job = job_;
+        n = n_;
+      }
+      _run(*job, n);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --running_;
+      }
+      done_.notify_one();
+    }
+  }
+
+ private:
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  bool stop_ = false;
+  std::size_t generation_ = 0;  // 每次parallel_for加1
+
+  const std::function<void(std::size_t)>* job_ = nullptr;
+  std::size_t n_ = 0;
+  std::atomic<std::size_t> next_{0};
+  std::size_t running_ = 0;  // 还没有完成当前任务的工作线程
+};
+}  // namespace wzj
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <geo/predicates.h>
+#include <geo/segment2d.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace geo {
+	// 轴对齐包围盒. 默认构造的是空盒子(min > max), 扩展任何点后变成非空.
+	// 用于线段求交前的快速排除, 以及建立空间索引(见rtree)
+	struct aabb2d {
+
+		aabb2d() {
+
+		}
+		aabb2d(double min_x, double min_y, double max_x, double max_y)
+			: min_x_(min_x), min_y_(min_y), max_x_(max_x), max_y_(max_y) {
+
+		}
+		explicit aabb2d(const segment2d& s)
+			: min_x_(std::min(s.st_.x_, s.en_.x_)), min_y_(std::min(s.st_.y_, s.en_.y_)),
+			max_x_(std::max(s.st_.x_, s.en_.x_)), max_y_(std::max(s.st_.y_, s.en_.y_)) {
+
+		}
+
+		bool empty() const {
+			return min_x_ > max_x_ || min_y_ > max_y_;
+		}
+
+		void expand(const point2d& p) {
+			min_x_ = std::min(min_x_, p.x_);
+			min_y_ = std::min(min_y_, p.y_);
+			max_x_ = std::max(max_x_, p.x_);
+			max_y_ = std::max(max_y_, p.y_);
+		}
+		void expand(const aabb2d& b) {
+			min_x_ = std::min(min_x_, b.min_x_);
+			min_y_ = std::min(min_y_, b.min_y_);
+			max_x_ = std::max(max_x_, b.max_x_);
+			max_y_ = std::max(max_y_, b.max_y_);
+		}
+		// 并集, 即同时包含两个盒子的最小盒子
+		aabb2d united(const aabb2d& b) const {
+			aabb2d ans = *this;
+			ans.expand(b);
+			return ans;
+		}
+		// 四周各扩大d
+		aabb2d inflated(double d) const {
+			return { min_x_ - d, min_y_ - d, max_x_ + d, max_y_ + d };
+		}
+
+		double width() const {
+			return max_x_ - min_x_;
+		}
+		double height() const {
+			return max_y_ - min_y_;
+		}
+		// 空盒子的面积为0
+		double area() const {
+			return empty() ? 0.0 : width() * height();
+		}
+
+		// 包括边界
+		bool contains(const point2d& p) const {
+			return min_x_ <= p.x_ && p.x_ <= max_x_ && min_y_ <= p.y_ && p.y_ <= max_y_;
+		}
+		// 有公共点(包括边界接触)
+		bool intersects(const aabb2d& b) const {
+			return min_x_ <= b.max_x_ && b.min_x_ <= max_x_ && min_y_ <= b.max_y_ && b.min_y_ <= max_y_;
+		}
+		// 两个盒子在x和y方向上的间隙都小于tol
+		bool intersects(const aabb2d& b, double tol) const {
+			return min_x_ - b.max_x_ < tol && b.min_x_ - max_x_ < tol && min_y_ - b.max_y_ < tol && b.min_y_ - max_y_ < tol;
+		}
+		// 和线段有公共点(精确判断). 包围盒相交, 并且盒子的四个角不全在线段所在直线的同一侧
+		bool intersects(const segment2d& s) const {
+			if (!intersects(aabb2d(s)))
+				return false;
+			if (contains(s.st_) || contains(s.en_))
+				return true;
+			int pos = 0, neg = 0;
+			for (auto& c : { point2d(min_x_, min_y_), point2d(max_x_, min_y_), point2d(max_x_, max_y_), point2d(min_x_, max_y_) }) {
+				int o = orient2d_sign(s.st_, s.en_, c);
+				pos += o > 0;
+				neg += o < 0;
+			}
+			return pos < 4 && neg < 4;
+		}
+
+		point2d center() const {
+			return { (min_x_ + max_x_) / 2, (min_y_ + max_y_) / 2 };
+		}
+
+		// p到盒子的最短距离的平方, p在盒子内时为0
+		double distance2(const point2d& p) const {
+			double dx = std::max({ min_x_ - p.x_, 0.0, p.x_ - max_x_ });
+			double dy = std::max({ min_y_ - p.y_, 0.0, p.y_ - max_y_ });
+			return dx * dx + dy * dy;
+		}
+
+		double min_x_ = std::numeric_limits<double>::infinity();
+		double min_y_ = std::numeric_limits<double>::infinity();
+		double max_x_ = -std::numeric_limits<double>::infinity();
+		double max_y_ = -std::numeric_limits<double>::infinity();
+	};
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <geo/aabb2d.h>
+#include <geo/segment2d.h>
+
+#include <utility>
+
+namespace geo {
+	/// <summary>
+	/// 保存了包围盒的线段. 求交前先比较包围盒, 离得远的线段只需要4次比较, 不用计算叉积和除法.
+	/// 构造后不要直接修改seg_, 否则box_会过期
+	/// </summary>
+	struct bounded_segment2d {
+
+		bounded_segment2d() {
+
+		}
+		explicit bounded_segment2d(const segment2d& seg) : seg_(seg), box_(seg) {
+
+		}
+
+		// segment2d::intersect接受离两条线段的端点都在tol以内的交点, 所以包围盒的间隙可以接近2*tol.
+		// 间隙不小于2*tol时不可能相交
+		bool may_intersect(const bounded_segment2d& other, double tol) const {
+			return box_.intersects(other.box_, 2 * tol);
+		}
+
+		/// <summary>
+		/// 先用包围盒排除(见may_intersect), 没有排除时调用segment2d::intersect.
+		/// 当other的长宽都小于tol时, segment2d::intersect可能报告远处的交点, 这里会被排除
+		/// </summary>
+		std::pair<point2d, bool> intersect(const bounded_segment2d& other, double tol, bool ignore_end = false) const {
+			if (!may_intersect(other, tol))
+				return {};
+			return seg_.intersect(other.seg_, tol, ignore_end);
+		}
+
+		operator const segment2d&() const {
+			return seg_;
+		}
+
+		segment2d seg_;
+		aabb2d box_;
+	};
+}
@@ -0,0 +1,130 @@
+#include <geo/kdtree.h>
+
+#include <geo/parallel.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace geo {
+	void kdtree::build(const std::vector<point2d>& pts) {
+		ids_.resize(pts.size());
+		std::iota(ids_.begin(), ids_.end(), 0u);
+		// 先排列下标, 最后再按下标复制点
+		points_ = pts;
+		_build(0, pts.size(), 0);
+		for (std::size_t i = 0; i < pts.size(); ++i)
+			points_[i] = pts[ids_[i]];
+	}
+
+	void kdtree::_build(std::size_t lo, std::size_t hi, int depth) {
+		// 尾递归改成循环, 只递归左子树
+		while (hi - lo > 1) {
+			auto m = (lo + hi) / 2;
+			int dim = depth & 1;
+			std::nth_element(ids_.begin() + lo, ids_.begin() + m, ids_.begin() + hi,
+				[&](std::uint32_t a, std::uint32_t b) { return points_[a][dim] < points_[b][dim]; });
+			_build(lo, m, depth + 1);
+			lo = m + 1;
+			++depth;
+		}
+	}
+
+	void kdtree::_knn(const point2d& p, std::size_t k, std::size_t lo, std::size_t hi, int depth,
+		std::vector<std::pair<double, std::uint32_t>>& heap, double& worst) const {
+		while (lo < hi) {
+			auto m = (lo + hi) / 2;
+			double d2 = (points_[m] - p).length2();
+			if (d2 < worst || (heap.size() < k && d2 <= worst)) {
+				heap.emplace_back(d2, ids_[m]);
+				std::push_heap(heap.begin(), heap.end());
+				if (heap.size() > k) {
+					std::pop_heap(heap.begin(), heap.end());
+					heap.pop_back();
+				}
+				if (heap.size() == k)
+					worst = std::min(worst, heap.front().first);
+			}
+			double diff = p[depth & 1] - points_[m][depth & 1];
+			// 先查p所在的一侧, 另一侧只在可能更近时才查
+			std::size_t near_lo = diff < 0 ? lo : m + 1, near_hi = diff < 0 ? m : hi;
+			std::size_t far_lo = diff < 0 ? m + 1 : lo, far_hi = diff < 0 ? hi : m;
+			_knn(p, k, near_lo, near_hi, depth + 1, heap, worst);
+			if (diff * diff > worst)
+				return;
+			lo = far_lo;
+			hi = far_hi;
+			++depth;
+		}
+	}
+
+	void kdtree::_radius(const point2d& p, double r2, std::size_t lo, std::size_t hi, int depth,
+		std::vector<std::uint32_t>& out) const {
+		while (lo < hi) {
+			auto m = (lo + hi) / 2;
+			if ((points_[m] - p).length2() <= r2)
+				out.push_back(ids_[m]);
+			double diff = p[depth & 1] - points_[m][depth & 1];
+			if (diff <= 0 || diff * diff <= r2)
+				_radius(p, r2, lo, m, depth + 1, out);
+			if (diff < 0 && diff * diff > r2)
+				return;
+			lo = m + 1;
+			++depth;
+		}
+	}
+
+	std::pair<std::uint32_t, double> kdtree::nearest(const point2d& p, double max_dist) const {
+		std::vector<std::pair<double, std::uint32_t>> heap;
+		double worst = max_dist * max_dist;
+		_knn(p, 1, 0, points_.size(), 0, heap, worst);
+		if (heap.empty())
+			return { npos, std::numeric_limits<double>::infinity() };
+		return { heap[0].second, heap[0].first };
+	}
+
+	std::vector<std::pair<std::uint32_t, double>> kdtree::nearest(const point2d& p, std::size_t k) const {
+		std::vector<std::pair<double, std::uint32_t>> heap;
+		std::vector<std::pair<std::uint32_t, double>> ans;
+		if (k == 0)
+			return ans;
+		double worst = std::numeric_limits<double>::infinity();
+		_knn(p, k, 0, points_.size(), 0, heap, worst);
+		std::sort_heap(heap.begin(), heap.end());
+		for (auto& h : heap)
+			ans.emplace_back(h.second, h.first);
+		return ans;
+	}
+
+	void kdtree::radius(const point2d& p, double r, std::vector<std::uint32_t>& out) const {
+		_radius(p, r * r, 0, points_.size(), 0, out);
+	}
+
+	void kdtree::nearest_batch(const std::vector<point2d>& qs, std::size_t k, std::vector<std::uint32_t>& ids,
+		std::vector<double>& dist2, unsigned threads) const {
+		ids.assign(qs.size() * k, npos);
+		dist2.assign(qs.size() * k, std::numeric_limits<double>::infinity());
+		parallel_for(qs.size(), threads, [&](std::size_t i) {
+			auto r = nearest(qs[i], k);
+			for (std::size_t j = 0; j < r.size(); ++j) {
+				ids[i * k + j] = r[j].first;
+				dist2[i * k + j] = r[j].second;
+			}
+		});
+	}
+
+	void kdtree::snap_batch(const std::vector<point2d>& qs, double max_dist, std::vector<std::uint32_t>& out,
+		unsigned threads) const {
+		out.resize(qs.size());
+		parallel_for(qs.size(), threads, [&](std::size_t i) {
+			out[i] = nearest(qs[i], max_dist).first;
+		});
+	}
+
+	void kdtree::radius_batch(const std::vector<point2d>& qs, double r, std::vector<std::vector<std::uint32_t>>& out,
+		unsigned threads) const {
+		out.assign(qs.size(), {});
+		parallel_for(qs.size(), threads, [&](std::size_t i) {
+			radius(qs[i], r, out[i]);
+		});
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <geo/point2d.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace geo {
+	/// <summary>
+	/// 静态的2维k-d tree. 隐式布局, 没有指针:
+	/// 区间[lo, hi)的根是中点m = (lo + hi) / 2, 左子树是[lo, m), 右子树是[m + 1, hi).
+	/// 深度为偶数时按x划分, 奇数时按y划分. 用nth_element建立, O(n log n).
+	/// 点按树的顺序重新排列并复制一份, ids()[i]是points()[i]的原始下标. 点的个数不能超过UINT32_MAX
+	/// </summary>
+	class kdtree {
+	public:
+		// 没有结果
+		static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+	public:
+		kdtree() {
+
+		}
+		explicit kdtree(const std::vector<point2d>& pts) {
+			build(pts);
+		}
+
+		void build(const std::vector<point2d>& pts);
+
+		/// <summary>
+		/// 距离不超过max_dist的最近点, 返回(原始下标, 距离的平方). 没有时返回(npos, inf)
+		/// </summary>
+		std::pair<std::uint32_t, double> nearest(const point2d& p,
+			double max_dist = std::numeric_limits<double>::infinity()) const;
+		/// <summary>
+		/// 最近的k个点, 返回(原始下标, 距离的平方), 按距离从小到大
+		/// </summary>
+		std::vector<std::pair<std::uint32_t, double>> nearest(const point2d& p, std::size_t k) const;
+		/// <summary>
+		/// 距离不超过r的点, 把原始下标追加到out. 顺序不确定
+		/// </summary>
+		void radius(const point2d& p, double r, std::vector<std::uint32_t>& out) const;
+
+		/// <summary>
+		/// 批量kNN. 第i个查询的结果在ids/dist2的[i*k, (i+1)*k), 按距离从小到大, 不足k个时用(npos, inf)补齐.
+		/// threads是线程数, 0表示std::thread::hardware_concurrency()
+		/// </summary>
+		void nearest_batch(const std::vector<point2d>& qs, std::size_t k, std::vector<std::uint32_t>& ids,
+			std::vector<double>& dist2, unsigned threads = 0) const;
+		/// <summary>
+		/// 批量最近点查询, 用于吸附: out[i]是距离qs[i]不超过max_dist的最近点, 没有时是npos
+		/// </summary>
+		void snap_batch(const std::vector<point2d>& qs, double max_dist, std::vector<std::uint32_t>& out,
+			unsigned threads = 0) const;
+		/// <summary>
+		/// 批量半径查询. out[i]是距离qs[i]不超过r的点
+		/// </summary>
+		void radius_batch(const std::vector<point2d>& qs, double r, std::vector<std::vector<std::uint32_t>>& out,
+			unsigned threads = 0) const;
+
+		std::size_t size() const {
+			return points_.size();
+		}
+		const std::vector<point2d>& points() const {
+			return points_;
+		}
+		const std::vector<std::uint32_t>& ids() const {
+			return ids_;
+		}
+
+	private:
+		void _build(std::size_t lo, std::size_t hi, int depth);
+
+		// 在[lo, hi)中查找, 结果是最大堆heap(按距离), 最多k个
+		void _knn(const point2d& p, std::size_t k, std::size_t lo, std::size_t hi, int depth,
+			std::vector<std::pair<double, std::uint32_t>>& heap, double& worst) const;
+		void _radius(const point2d& p, double r2, std::size_t lo, std::size_t hi, int depth,
+			std::vector<std::uint32_t>& out) const;
+
+	private:
+		std::vector<point2d> points_;
+		std::vector<std::uint32_t> ids_;
+	};
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace geo {
+	// threads为0时使用的线程数
+	inline unsigned default_threads() {
+		return std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// 把[0, count)按块分给threads个线程, 每个线程对自己的块依次执行fn(i). threads==0表示default_threads()
+	template <typename _Fn>
+	void parallel_for(std::size_t count, unsigned threads, _Fn fn) {
+		if (threads == 0)
+			threads = default_threads();
+		threads = static_cast<unsigned>(std::min<std::size_t>(threads, count));
+		if (threads <= 1) {
+			for (std::size_t i = 0; i < count; ++i)
+				fn(i);
+			return;
+		}
+		std::vector<std::thread> pool;
+		for (unsigned t = 0; t < threads; ++t)
+			pool.emplace_back([=, &fn]() {
+				for (auto i = count * t / threads; i < count * (t + 1) / threads; ++i)
+					fn(i);
+			});
+		for (auto& th : pool)
+			th.join();
+	}
+}
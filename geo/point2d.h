@@ -1,64 +1,131 @@
 #pragma once
 
+#include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 
 namespace geo {
-	// 既是向量, 又是点
-	struct point2d {
+	/// <summary>
+	/// 坐标类型T的运算类型.
+	/// wide_type: 两个坐标的乘积以及两个乘积的和/差不会溢出, 用于dot, cross, length2.
+	/// exact_type: 两个坐标差的乘积不会溢出, 用于三个点的方向判断.
+	/// 浮点坐标都用double计算. 整数坐标最多32位
+	/// </summary>
+	template <typename T>
+	struct coord_traits {
+		static_assert(std::is_floating_point<T>::value, "unsupported coordinate type");
+		using wide_type = double;
+		using exact_type = double;
+	};
+	template <>
+	struct coord_traits<std::int16_t> {
+		using wide_type = std::int32_t;
+		using exact_type = std::int64_t;
+	};
+	// 没有128位整数时(例如MSVC), exact_type是int64_t, orient2d_sign改用detail::product_diff_sign精确比较两个乘积
+	template <>
+	struct coord_traits<std::int32_t> {
+		using wide_type = std::int64_t;
+#if defined(__SIZEOF_INT128__)
+		__extension__ typedef __int128 exact_type;
+#else
+		using exact_type = std::int64_t;
+#endif
+	};
 
-		point2d() {
+	// 既是向量, 又是点. T是坐标类型: double, float, int32_t, int16_t
+	template <typename T>
+	struct basic_point2d {
+		using value_type = T;
+		using wide_type = typename coord_traits<T>::wide_type;
+
+		basic_point2d() {
+
+		}
+		basic_point2d(T x, T y) : x_(x), y_(y) {
 
 		}
-		point2d(double x, double y) : x_(x), y_(y) {
+		// 不同坐标类型之间显式转换
+		template <typename U>
+		explicit basic_point2d(const basic_point2d<U>& other) : x_(static_cast<T>(other.x_)), y_(static_cast<T>(other.y_)) {
 
 		}
 
-		double length2() const {
-			return x_ * x_ + y_ * y_;
+		wide_type length2() const {
+			return wide_type(x_) * x_ + wide_type(y_) * y_;
 		}
 
-		double operator[](const int idx) const {
+		T operator[](const int idx) const {
 			return idx == 0 ? x_ : y_;
 		}
 
-		double dot(const point2d& other) const {
-			return x_ * other.x_ + y_ * other.y_;
+		wide_type dot(const basic_point2d& other) const {
+			return wide_type(x_) * other.x_ + wide_type(y_) * other.y_;
 		}
 
-		double cross(const point2d& v) const {
-			return x_ * v.y_ - y_ * v.x_;
+		wide_type cross(const basic_point2d& v) const {
+			return wide_type(x_) * v.y_ - wide_type(y_) * v.x_;
 		}
 
 		bool is_zero(double tol) const {
 			return std::fabs(x_) < tol && std::fabs(y_) < tol;
 		}
+		// 精确判断, 用于整数坐标
+		bool is_zero() const {
+			return x_ == 0 && y_ == 0;
+		}
 
-		bool is_parallel(const point2d& other, double tol) const {
+		bool is_parallel(const basic_point2d& other, double tol) const {
 			return std::fabs(cross(other)) < tol;
 		}
+		// 精确判断, 用于整数坐标
+		bool is_parallel(const basic_point2d& other) const {
+			return cross(other) == 0;
+		}
 
-		point2d operator*(double k) const {
-			return { x_ * k, y_ * k };
+		/// <summary>
+		/// 结果的坐标类型仍是T. 整数坐标的积, 和, 差必须在T的范围内, 用wide_type计算后断言检查.
+		/// 例如point2di(-2e9, 0) - point2di(2e9, 0)超出int32, 需要坐标差的地方(orient2d_sign)直接用exact_type计算
+		/// </summary>
+		basic_point2d operator*(T k) const {
+			return { narrow(wide_type(x_) * k), narrow(wide_type(y_) * k) };
 		}
-		point2d operator/(double k) const {
-			return { x_ / k, y_ / k };
+		basic_point2d operator/(T k) const {
+			return { T(x_ / k), T(y_ / k) };
 		}
-		point2d operator+(const point2d& v) const {
-			return { x_ + v.x_, y_ + v.y_ };
+		basic_point2d operator+(const basic_point2d& v) const {
+			return { narrow(wide_type(x_) + v.x_), narrow(wide_type(y_) + v.y_) };
 		}
-		point2d operator-(const point2d& v) const {
-			return { x_ - v.x_, y_ - v.y_ };
+		basic_point2d operator-(const basic_point2d& v) const {
+			return { narrow(wide_type(x_) - v.x_), narrow(wide_type(y_) - v.y_) };
 		}
-		bool operator==(const point2d& other) const {
-			return fabs(x_ - other.x_) < 1e-9 && fabs(y_ - other.y_) < 1e-9;
+		// 浮点坐标允许1e-9的误差, 整数坐标精确比较
+		bool operator==(const basic_point2d& other) const {
+			if constexpr (std::is_floating_point<T>::value)
+				return std::fabs(x_ - other.x_) < 1e-9 && std::fabs(y_ - other.y_) < 1e-9;
+			else
+				return x_ == other.x_ && y_ == other.y_;
 		}
 
 
-		friend point2d operator*(double k, const point2d& pt) {
+		friend basic_point2d operator*(T k, const basic_point2d& pt) {
 			return pt * k;
 		}
 
-		double x_ = 0;
-		double y_ = 0;
+		T x_ = 0;
+		T y_ = 0;
+
+	private:
+		static T narrow(wide_type v) {
+			if constexpr (std::is_integral<T>::value)
+				assert(v >= std::numeric_limits<T>::min() && v <= std::numeric_limits<T>::max());
+			return T(v);
+		}
 	};
-}
\ No newline at end of file
+
+	using point2d = basic_point2d<double>;
+	using point2df = basic_point2d<float>;
+	using point2di = basic_point2d<std::int32_t>;
+}
@@ -0,0 +1,58 @@
+#include <geo/point_hash_set.h>
+
+#include <cmath>
+
+namespace geo {
+	std::int64_t point_hash_set::_cell(double v) const {
+		constexpr double limit = 4611686018427387904.0;  // 2^62
+		double c = std::floor(v / tol_);
+		if (!(c > -limit))  // 包括NaN
+			return -static_cast<std::int64_t>(limit);
+		if (c > limit)
+			return static_cast<std::int64_t>(limit);
+		return static_cast<std::int64_t>(c);
+	}
+
+	std::uint64_t point_hash_set::_key(std::int64_t cx, std::int64_t cy) {
+		// 不同的格子可能得到相同的key, 只是多比较几个点
+		auto k = static_cast<std::uint64_t>(cx) * 0x9E3779B97F4A7C15ull ^ static_cast<std::uint64_t>(cy);
+		k ^= k >> 31;
+		return k * 0xBF58476D1CE4E5B9ull;
+	}
+
+	std::uint32_t point_hash_set::find(const point2d& p) const {
+		auto cx = _cell(p.x_), cy = _cell(p.y_);
+		std::uint32_t best = npos;
+		double best_d2 = 0;
+		for (std::int64_t dx = -1; dx <= 1; ++dx)
+			for (std::int64_t dy = -1; dy <= 1; ++dy) {
+				auto it = cells_.find(_key(cx + dx, cy + dy));
+				if (it == cells_.end())
+					continue;
+				for (auto i = it->second; i != npos; i = next_[i]) {
+					auto d = points_[i] - p;
+					if (!d.is_zero(tol_))
+						continue;
+					// 距离相同时取下标小的, 结果不依赖格子的遍历顺序
+					double d2 = d.length2();
+					if (best == npos || d2 < best_d2 || (d2 == best_d2 && i < best)) {
+						best = i;
+						best_d2 = d2;
+					}
+				}
+			}
+		return best;
+	}
+
+	std::pair<std::uint32_t, bool> point_hash_set::insert(const point2d& p) {
+		auto found = find(p);
+		if (found != npos)
+			return { found, false };
+		auto id = static_cast<std::uint32_t>(points_.size());
+		points_.push_back(p);
+		auto it = cells_.emplace(_key(_cell(p.x_), _cell(p.y_)), npos).first;
+		next_.push_back(it->second);
+		it->second = id;
+		return { id, true };
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <geo/point2d.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace geo {
+	/// <summary>
+	/// 带误差的点集合, 用于合并重合的点. 两个点重合是指(a - b).is_zero(tol), 即两个坐标的差都小于tol.
+	/// 1. 按格子(floor(x/tol), floor(y/tol))分桶, 重合的点一定在相邻的3x3个格子中. 插入和查找的期望代价是O(1)
+	/// 2. 重合不是传递的. 插入时如果已有重合的点, 返回其中最近的一个(代表点), 新的点不保存.
+	///    所以结果和插入顺序有关, 但代表点两两不重合
+	/// 3. 点的下标按插入顺序, 不会改变. 点的个数不能超过UINT32_MAX
+	/// </summary>
+	class point_hash_set {
+	public:
+		// 没有结果
+		static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+	public:
+		// tol必须大于0
+		explicit point_hash_set(double tol = 1e-9) : tol_(tol) {
+
+		}
+
+		/// <summary>
+		/// 插入p. 返回(代表点的下标, 是否是新插入的)
+		/// </summary>
+		std::pair<std::uint32_t, bool> insert(const point2d& p);
+		/// <summary>
+		/// 和p重合的最近的点的下标, 没有时返回npos
+		/// </summary>
+		std::uint32_t find(const point2d& p) const;
+
+		bool contains(const point2d& p) const {
+			return find(p) != npos;
+		}
+		void reserve(std::size_t n) {
+			points_.reserve(n);
+			next_.reserve(n);
+			cells_.reserve(n);
+		}
+		void clear() {
+			points_.clear();
+			next_.clear();
+			cells_.clear();
+		}
+
+		std::size_t size() const {
+			return points_.size();
+		}
+		double tol() const {
+			return tol_;
+		}
+		// 按插入顺序的代表点
+		const std::vector<point2d>& points() const {
+			return points_;
+		}
+
+	private:
+		// 格子坐标, 截断到不会溢出的范围. 截断后远处的点会落入同一个格子, 只影响速度
+		std::int64_t _cell(double v) const;
+		static std::uint64_t _key(std::int64_t cx, std::int64_t cy);
+
+	private:
+		double tol_;
+		std::vector<point2d> points_;
+		// 同一个格子中的点组成单链表: cells_是第一个点, next_[i]是点i的下一个点
+		std::vector<std::uint32_t> next_;
+		std::unordered_map<std::uint64_t, std::uint32_t> cells_;
+	};
+}
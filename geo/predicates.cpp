@@ -0,0 +1,208 @@
+#include <geo/predicates.h>
+
+#include <algorithm>
+
+namespace geo {
+	namespace {
+		// 无误差变换: 每个函数返回的x + y精确等于运算的真实结果, x是舍入后的值
+		const double epsilon = 1.1102230246251565e-16;  // 2^-53
+		const double splitter = 134217729.0;             // 2^27 + 1
+		const double resulterrbound = (3.0 + 8.0 * epsilon) * epsilon;
+		const double ccwerrboundA = (3.0 + 16.0 * epsilon) * epsilon;
+		const double ccwerrboundB = (2.0 + 12.0 * epsilon) * epsilon;
+		const double ccwerrboundC = (9.0 + 64.0 * epsilon) * epsilon * epsilon;
+
+		// 要求|a| >= |b|
+		inline void fast_two_sum(double a, double b, double& x, double& y) {
+			x = a + b;
+			double bvirt = x - a;
+			y = b - bvirt;
+		}
+		inline void two_sum(double a, double b, double& x, double& y) {
+			x = a + b;
+			double bvirt = x - a;
+			double avirt = x - bvirt;
+			y = (a - avirt) + (b - bvirt);
+		}
+		// 已知x = a - b的舍入结果, 求误差
+		inline double two_diff_tail(double a, double b, double x) {
+			double bvirt = a - x;
+			double avirt = x + bvirt;
+			return (a - avirt) + (bvirt - b);
+		}
+		inline void two_diff(double a, double b, double& x, double& y) {
+			x = a - b;
+			y = two_diff_tail(a, b, x);
+		}
+		// 把a分成高低各26位
+		inline void split(double a, double& hi, double& lo) {
+			double c = splitter * a;
+			double abig = c - a;
+			hi = c - abig;
+			lo = a - hi;
+		}
+		inline void two_product(double a, double b, double& x, double& y) {
+			x = a * b;
+			double ahi, alo, bhi, blo;
+			split(a, ahi, alo);
+			split(b, bhi, blo);
+			double err1 = x - ahi * bhi;
+			double err2 = err1 - alo * bhi;
+			double err3 = err2 - ahi * blo;
+			y = alo * blo - err3;
+		}
+		// (a1 + a0) - (b1 + b0), 结果是4项的展开式x[0..3], 从小到大
+		inline void two_two_diff(double a1, double a0, double b1, double b0, double* x) {
+			double i, j, k;
+			two_diff(a0, b0, i, x[0]);
+			two_sum(a1, i, j, k);
+			two_diff(k, b1, i, x[1]);
+			two_sum(j, i, x[3], x[2]);
+		}
+
+		// h = e + f, 去掉0项. 返回h的长度. h至少要有elen + flen项
+		int fast_expansion_sum_zeroelim(int elen, const double* e, int flen, const double* f, double* h) {
+			int eindex = 0, findex = 0, hindex = 0;
+			double enow = e[0], fnow = f[0];
+			double q, qnew, hh;
+			// 按绝对值从小到大合并
+			auto take_e = [&]() { return (fnow > enow) == (fnow > -enow); };
+			auto next_e = [&]() { if (++eindex < elen) enow = e[eindex]; };
+			auto next_f = [&]() { if (++findex < flen) fnow = f[findex]; };
+			if (take_e()) {
+				q = enow;
+				next_e();
+			}
+			else {
+				q = fnow;
+				next_f();
+			}
+			if (eindex < elen && findex < flen) {
+				if (take_e()) {
+					fast_two_sum(enow, q, qnew, hh);
+					next_e();
+				}
+				else {
+					fast_two_sum(fnow, q, qnew, hh);
+					next_f();
+				}
+				q = qnew;
+				if (hh != 0.0)
+					h[hindex++] = hh;
+				while (eindex < elen && findex < flen) {
+					if (take_e()) {
+						two_sum(q, enow, qnew, hh);
+						next_e();
+					}
+					else {
+						two_sum(q, fnow, qnew, hh);
+						next_f();
+					}
+					q = qnew;
+					if (hh != 0.0)
+						h[hindex++] = hh;
+				}
+			}
+			while (eindex < elen) {
+				two_sum(q, enow, qnew, hh);
+				next_e();
+				q = qnew;
+				if (hh != 0.0)
+					h[hindex++] = hh;
+			}
+			while (findex < flen) {
+				two_sum(q, fnow, qnew, hh);
+				next_f();
+				q = qnew;
+				if (hh != 0.0)
+					h[hindex++] = hh;
+			}
+			if (q != 0.0 || hindex == 0)
+				h[hindex++] = q;
+			return hindex;
+		}
+
+		double estimate(int elen, const double* e) {
+			double q = e[0];
+			for (int i = 1; i < elen; ++i)
+				q += e[i];
+			return q;
+		}
+
+		// double的结果不可靠时, 逐级提高精度. detsum是|detleft| + |detright|
+		double orient2d_adapt(const point2d& a, const point2d& b, const point2d& c, double detsum) {
+			double acx = a.x_ - c.x_, bcx = b.x_ - c.x_;
+			double acy = a.y_ - c.y_, bcy = b.y_ - c.y_;
+
+			// B: 忽略坐标相减的误差, 精确计算行列式
+			double detleft, detlefttail, detright, detrighttail;
+			two_product(acx, bcy, detleft, detlefttail);
+			two_product(acy, bcx, detright, detrighttail);
+			double B[4];
+			two_two_diff(detleft, detlefttail, detright, detrighttail, B);
+			double det = estimate(4, B);
+			double errbound = ccwerrboundB * detsum;
+			if (det >= errbound || -det >= errbound)
+				return det;
+
+			// 坐标相减的误差
+			double acxtail = two_diff_tail(a.x_, c.x_, acx);
+			double bcxtail = two_diff_tail(b.x_, c.x_, bcx);
+			double acytail = two_diff_tail(a.y_, c.y_, acy);
+			double bcytail = two_diff_tail(b.y_, c.y_, bcy);
+			if (acxtail == 0.0 && acytail == 0.0 && bcxtail == 0.0 && bcytail == 0.0)
+				return det;
+
+			// C: 一阶修正
+			errbound = ccwerrboundC * detsum + resulterrbound * std::fabs(det);
+			det += (acx * bcytail + bcy * acxtail) - (acy * bcxtail + bcx * acytail);
+			if (det >= errbound || -det >= errbound)
+				return det;
+
+			// D: 精确展开式
+			double s1, s0, t1, t0, u[4];
+			double C1[8], C2[12], D[16];
+			two_product(acxtail, bcy, s1, s0);
+			two_product(acytail, bcx, t1, t0);
+			two_two_diff(s1, s0, t1, t0, u);
+			int c1len = fast_expansion_sum_zeroelim(4, B, 4, u, C1);
+
+			two_product(acx, bcytail, s1, s0);
+			two_product(acy, bcxtail, t1, t0);
+			two_two_diff(s1, s0, t1, t0, u);
+			int c2len = fast_expansion_sum_zeroelim(c1len, C1, 4, u, C2);
+
+			two_product(acxtail, bcytail, s1, s0);
+			two_product(acytail, bcxtail, t1, t0);
+			two_two_diff(s1, s0, t1, t0, u);
+			int dlen = fast_expansion_sum_zeroelim(c2len, C2, 4, u, D);
+
+			return D[dlen - 1];
+		}
+	}
+
+	double orient2d(const point2d& a, const point2d& b, const point2d& c) {
+		// 快速路径: 误差界足够小时直接返回double的结果
+		double detleft = (a.x_ - c.x_) * (b.y_ - c.y_);
+		double detright = (a.y_ - c.y_) * (b.x_ - c.x_);
+		double det = detleft - detright;
+		double detsum;
+		if (detleft > 0) {
+			if (detright <= 0)
+				return det;
+			detsum = detleft + detright;
+		}
+		else if (detleft < 0) {
+			if (detright >= 0)
+				return det;
+			detsum = -detleft - detright;
+		}
+		else {
+			return det;
+		}
+		double errbound = ccwerrboundA * detsum;
+		if (det >= errbound || -det >= errbound)
+			return det;
+		return orient2d_adapt(a, b, c, detsum);
+	}
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <geo/segment2d.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+namespace geo {
+	/// <summary>
+	/// 鲁棒的几何谓词(Shewchuk, Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates).
+	/// 先用double计算并检查误差界, 只有结果可能出错时才逐级提高精度, 最后用精确的展开式(expansion)运算.
+	/// 结果的符号总是精确的, 不需要tol. 要求IEEE双精度并且就近舍入, 不能用-ffast-math编译.
+	/// predicates.cpp也不能把乘加合并成FMA: geo/CMakeLists.txt对它使用-ffp-contract=off, 其他构建方式需要同样处理
+	/// </summary>
+
+	/// <summary>
+	/// 返回值的符号: c在有向直线ab左侧(逆时针)为正, 右侧为负, 三点共线为0.
+	/// 绝对值近似等于(b-a)x(c-a)
+	/// </summary>
+	double orient2d(const point2d& a, const point2d& b, const point2d& c);
+
+	// 两条线段的位置关系
+	enum class segment_crossing {
+		none,     // 不相交
+		proper,   // 在两条线段内部交于一点
+		touch,    // 交于一点, 且该点是某条线段的端点
+		overlap,  // 共线并且有公共部分(多于一个点)
+	};
+
+	namespace detail {
+		// 64位无符号乘法的128位结果(hi, lo). 拆成32位的两半计算
+		inline void mul_u64(std::uint64_t a, std::uint64_t b, std::uint64_t& hi, std::uint64_t& lo) {
+			std::uint64_t a0 = a & 0xffffffffu, a1 = a >> 32, b0 = b & 0xffffffffu, b1 = b >> 32;
+			std::uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+			std::uint64_t mid = (p00 >> 32) + (p01 & 0xffffffffu) + (p10 & 0xffffffffu);
+			lo = (mid << 32) | (p00 & 0xffffffffu);
+			hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+		}
+
+		// a * b - c * d的符号, 不需要128位整数类型
+		inline int product_diff_sign(std::int64_t a, std::int64_t b, std::int64_t c, std::int64_t d) {
+			auto magnitude = [](std::int64_t v) { return v < 0 ? 0 - static_cast<std::uint64_t>(v) : static_cast<std::uint64_t>(v); };
+			int s1 = (a != 0 && b != 0) ? ((a < 0) != (b < 0) ? -1 : 1) : 0;
+			int s2 = (c != 0 && d != 0) ? ((c < 0) != (d < 0) ? -1 : 1) : 0;
+			if (s1 != s2)
+				return s1 > s2 ? 1 : -1;
+			if (s1 == 0)
+				return 0;
+			std::uint64_t h1, l1, h2, l2;
+			mul_u64(magnitude(a), magnitude(b), h1, l1);
+			mul_u64(magnitude(c), magnitude(d), h2, l2);
+			int cmp = h1 != h2 ? (h1 > h2 ? 1 : -1) : (l1 != l2 ? (l1 > l2 ? 1 : -1) : 0);
+			return s1 > 0 ? cmp : -cmp;
+		}
+
+		// 已知p和线段s共线, p是否在s的包围盒内(包括边界)
+		template <typename T>
+		bool on_collinear(const basic_point2d<T>& p, const basic_segment2d<T>& s) {
+			return std::min(s.st_.x_, s.en_.x_) <= p.x_ && p.x_ <= std::max(s.st_.x_, s.en_.x_) &&
+				std::min(s.st_.y_, s.en_.y_) <= p.y_ && p.y_ <= std::max(s.st_.y_, s.en_.y_);
+		}
+	}
+
+	/// <summary>
+	/// orient2d的符号: 1, -1或0. 浮点坐标转换成double后用orient2d;
+	/// 整数坐标用coord_traits<T>::exact_type精确计算, 不会溢出
+	/// </summary>
+	template <typename T>
+	int orient2d_sign(const basic_point2d<T>& a, const basic_point2d<T>& b, const basic_point2d<T>& c) {
+		if constexpr (std::is_floating_point<T>::value) {
+			double det = orient2d(point2d(a), point2d(b), point2d(c));
+			return (det > 0) - (det < 0);
+		}
+		else {
+			using E = typename coord_traits<T>::exact_type;
+			E acx = E(a.x_) - c.x_, bcy = E(b.y_) - c.y_;
+			E acy = E(a.y_) - c.y_, bcx = E(b.x_) - c.x_;
+			if constexpr (sizeof(E) > 2 * sizeof(T)) {
+				E det = acx * bcy - acy * bcx;
+				return (det > 0) - (det < 0);
+			}
+			else {
+				// E放不下乘积, 见coord_traits<std::int32_t>
+				return detail::product_diff_sign(acx, bcy, acy, bcx);
+			}
+		}
+	}
+
+	// 精确判断两条线段的位置关系. 退化成点的线段也可以
+	template <typename T>
+	segment_crossing crossing(const basic_segment2d<T>& s1, const basic_segment2d<T>& s2) {
+		using detail::on_collinear;
+		int o1 = orient2d_sign(s1.st_, s1.en_, s2.st_);
+		int o2 = orient2d_sign(s1.st_, s1.en_, s2.en_);
+		int o3 = orient2d_sign(s2.st_, s2.en_, s1.st_);
+		int o4 = orient2d_sign(s2.st_, s2.en_, s1.en_);
+
+		if (o1 * o2 < 0 && o3 * o4 < 0)
+			return segment_crossing::proper;
+
+		if (o1 == 0 && o2 == 0 && o3 == 0 && o4 == 0) {
+			// 共线(或者有线段退化成点). 公共部分是两个区间的交
+			const basic_point2d<T>* common = nullptr;
+			for (auto p : { &s1.st_, &s1.en_, &s2.st_, &s2.en_ }) {
+				if (!on_collinear(*p, s1) || !on_collinear(*p, s2))
+					continue;
+				if (common == nullptr)
+					common = p;
+				// 有两个不同的公共点
+				else if (p->x_ != common->x_ || p->y_ != common->y_)
+					return segment_crossing::overlap;
+			}
+			return common ? segment_crossing::touch : segment_crossing::none;
+		}
+
+		// 某个端点在另一条线段上
+		if ((o1 == 0 && on_collinear(s2.st_, s1)) || (o2 == 0 && on_collinear(s2.en_, s1)) ||
+			(o3 == 0 && on_collinear(s1.st_, s2)) || (o4 == 0 && on_collinear(s1.en_, s2)))
+			return segment_crossing::touch;
+		return segment_crossing::none;
+	}
+
+	// 两条线段是否有公共点. ignore_end==true时只算proper
+	template <typename T>
+	bool segments_intersect(const basic_segment2d<T>& s1, const basic_segment2d<T>& s2, bool ignore_end = false) {
+		auto r = crossing(s1, s2);
+		return ignore_end ? r == segment_crossing::proper : r != segment_crossing::none;
+	}
+}
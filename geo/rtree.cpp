@@ -0,0 +1,282 @@
+#include <geo/rtree.h>
+
+#include <geo/parallel.h>
+#include <geo/predicates.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <tuple>
+
+namespace geo {
+	namespace {
+		const char kMagic[8] = { 'W', 'Z', 'J', 'R', 'T', 'R', 'E', '1' };
+
+		// 文件头, 后面依次是nodes, segs, ids. 每一段按8字节对齐
+		struct header {
+			char magic[8];
+			std::uint64_t size;
+			std::uint64_t node_count;
+			std::uint64_t bytes;  // 包括文件头的总长度
+		};
+
+		std::size_t align8(std::size_t x) {
+			return (x + 7) / 8 * 8;
+		}
+
+		// 各段的偏移
+		struct layout {
+			layout(std::size_t n, std::size_t node_count) {
+				nodes = sizeof(header);
+				segs = nodes + align8(sizeof(rtree::node) * node_count);
+				ids = segs + align8(sizeof(segment2d) * n);
+				bytes = ids + align8(sizeof(std::uint32_t) * n);
+			}
+			std::size_t nodes, segs, ids, bytes;
+		};
+
+		// 待打包的项: 线段或者下一层的节点
+		struct entry {
+			aabb2d box;
+			std::uint32_t id;
+		};
+
+		/// <summary>
+		/// STR: 按中心的x分成S个竖条, 每个竖条按中心的y排序. 之后每连续fanout_个项属于同一个父节点.
+		/// 竖条的边界用nth_element二分确定, O(n log S); 竖条内的排序并行
+		/// </summary>
+		void str_pack(std::vector<entry>& items, unsigned threads) {
+			auto n = items.size();
+			auto B = rtree::fanout_;
+			auto parents = (n + B - 1) / B;
+			auto S = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(parents))));
+			auto slice = S * B;
+			auto by_x = [](const entry& a, const entry& b) {
+				return a.box.min_x_ + a.box.max_x_ < b.box.min_x_ + b.box.max_x_;
+			};
+			auto by_y = [](const entry& a, const entry& b) {
+				return a.box.min_y_ + a.box.max_y_ < b.box.min_y_ + b.box.max_y_;
+			};
+			// 第[lo, hi)个竖条
+			std::vector<std::pair<std::size_t, std::size_t>> todo = { {0, S} };
+			while (!todo.empty()) {
+				auto r = todo.back();
+				todo.pop_back();
+				if (r.second - r.first <= 1)
+					continue;
+				auto mid = (r.first + r.second) / 2;
+				auto first = items.begin() + std::min(n, r.first * slice);
+				auto last = items.begin() + std::min(n, r.second * slice);
+				auto pivot = items.begin() + std::min(n, mid * slice);
+				if (first < pivot && pivot < last)
+					std::nth_element(first, pivot, last, by_x);
+				todo.emplace_back(r.first, mid);
+				todo.emplace_back(mid, r.second);
+			}
+			parallel_for(S, threads, [&](std::size_t s) {
+				auto first = std::min(n, s * slice), last = std::min(n, (s + 1) * slice);
+				std::sort(items.begin() + first, items.begin() + last, by_y);
+			});
+		}
+
+		// p到线段s的最短距离的平方
+		double distance2(const point2d& p, const segment2d& s) {
+			auto d = s.en_ - s.st_;
+			double len2 = d.length2();
+			double t = len2 > 0 ? std::max(0.0, std::min(1.0, (p - s.st_).dot(d) / len2)) : 0.0;
+			return (s.st_ + d * t - p).length2();
+		}
+	}
+
+	void rtree::build(const std::vector<segment2d>& segs, unsigned threads) {
+		clear();
+		if (threads == 0)
+			threads = default_threads();
+
+		// 叶子层
+		std::vector<entry> items(segs.size());
+		parallel_for(segs.size(), threads, [&](std::size_t i) {
+			items[i] = { aabb2d(segs[i]), static_cast<std::uint32_t>(i) };
+		});
+		std::vector<node> all;
+		if (!items.empty()) {
+			str_pack(items, threads);
+			// 当前层的节点, 它们在all中的起点是level_start
+			std::vector<entry> level;
+			for (std::size_t i = 0; i < items.size(); i += fanout_) {
+				node nd{ aabb2d(), static_cast<std::uint32_t>(i),
+					static_cast<std::uint16_t>(std::min(fanout_, items.size() - i)), 1 };
+				for (std::size_t j = i; j < i + nd.count_; ++j)
+					nd.box_.expand(items[j].box);
+				level.push_back({ nd.box_, static_cast<std::uint32_t>(all.size()) });
+				all.push_back(nd);
+			}
+			std::size_t level_start = 0;
+			while (level.size() > 1) {
+				// 打包当前层, 按打包后的顺序重新排列all中这一层的节点
+				str_pack(level, threads);
+				std::vector<node> packed;
+				for (auto& e : level)
+					packed.push_back(all[e.id]);
+				std::copy(packed.begin(), packed.end(), all.begin() + level_start);
+
+				auto next_start = all.size();
+				std::vector<entry> parents;
+				for (std::size_t i = 0; i < level.size(); i += fanout_) {
+					node nd{ aabb2d(), static_cast<std::uint32_t>(level_start + i),
+						static_cast<std::uint16_t>(std::min(fanout_, level.size() - i)), 0 };
+					for (std::size_t j = i; j < i + nd.count_; ++j)
+						nd.box_.expand(level[j].box);
+					parents.push_back({ nd.box_, static_cast<std::uint32_t>(all.size()) });
+					all.push_back(nd);
+				}
+				level.swap(parents);
+				level_start = next_start;
+			}
+		}
+
+		layout lay(segs.size(), all.size());
+		storage_.assign(lay.bytes / 8, 0);
+		auto base = reinterpret_cast<unsigned char*>(storage_.data());
+		header h;
+		std::memcpy(h.magic, kMagic, sizeof(kMagic));
+		h.size = segs.size();
+		h.node_count = all.size();
+		h.bytes = lay.bytes;
+		std::memcpy(base, &h, sizeof(h));
+		if (!all.empty())
+			std::memcpy(base + lay.nodes, all.data(), sizeof(node) * all.size());
+		auto out_segs = reinterpret_cast<segment2d*>(base + lay.segs);
+		auto out_ids = reinterpret_cast<std::uint32_t*>(base + lay.ids);
+		parallel_for(items.size(), threads, [&](std::size_t i) {
+			out_segs[i] = segs[items[i].id];
+			out_ids[i] = items[i].id;
+		});
+		attach(base, lay.bytes);
+	}
+
+	void rtree::clear() {
+		file_.close();
+		storage_.clear();
+		data_ = nullptr;
+		size_ = node_count_ = 0;
+		nodes_ = nullptr;
+		segs_ = nullptr;
+		ids_ = nullptr;
+	}
+
+	bool rtree::attach(const unsigned char* data, std::size_t bytes) {
+		header h;
+		if (!wzj::read_header(data, bytes, kMagic, h) || h.size > UINT32_MAX || h.node_count > bytes / sizeof(node))
+			return false;
+		layout lay(h.size, h.node_count);
+		if (h.bytes != lay.bytes || bytes < lay.bytes || (h.size == 0) != (h.node_count == 0))
+			return false;
+
+		// 文件可能损坏. 查询时用节点中的first_, count_做下标, 先检查它们不会越界.
+		// 内部节点的子节点都在它前面, 所以从根出发的遍历一定会结束
+		auto nodes = reinterpret_cast<const node*>(data + lay.nodes);
+		auto ids = reinterpret_cast<const std::uint32_t*>(data + lay.ids);
+		for (std::size_t i = 0; i < h.node_count; ++i) {
+			auto& nd = nodes[i];
+			std::uint64_t end = std::uint64_t(nd.first_) + nd.count_;
+			if (nd.count_ > fanout_ || end > (nd.leaf_ ? h.size : i))
+				return false;
+		}
+		for (std::size_t i = 0; i < h.size; ++i) {
+			if (ids[i] >= h.size)
+				return false;
+		}
+
+		data_ = data;
+		size_ = h.size;
+		node_count_ = h.node_count;
+		nodes_ = nodes;
+		segs_ = reinterpret_cast<const segment2d*>(data + lay.segs);
+		ids_ = ids;
+		return true;
+	}
+
+	bool rtree::save(const std::string& path) const {
+		if (data_ == nullptr)
+			return false;
+		header h;
+		std::memcpy(&h, data_, sizeof(h));
+		return wzj::write_file(path, data_, h.bytes);
+	}
+
+	bool rtree::load(const std::string& path) {
+		clear();
+		if (!file_.open(path, false) || !attach(reinterpret_cast<const unsigned char*>(file_.data()), file_.size())) {
+			clear();
+			return false;
+		}
+		return true;
+	}
+
+	void rtree::query_box(const aabb2d& box, std::vector<std::uint32_t>& out) const {
+		if (node_count_ == 0)
+			return;
+		std::vector<std::uint32_t> stack = { static_cast<std::uint32_t>(node_count_ - 1) };
+		while (!stack.empty()) {
+			auto& nd = nodes_[stack.back()];
+			stack.pop_back();
+			if (!box.intersects(nd.box_))
+				continue;
+			for (std::uint32_t i = nd.first_; i < nd.first_ + nd.count_; ++i) {
+				if (!nd.leaf_)
+					stack.push_back(i);
+				else if (box.intersects(segs_[i]))
+					out.push_back(ids_[i]);
+			}
+		}
+	}
+
+	void rtree::query_segment(const segment2d& seg, std::vector<std::uint32_t>& out) const {
+		if (node_count_ == 0)
+			return;
+		aabb2d seg_box(seg);
+		std::vector<std::uint32_t> stack = { static_cast<std::uint32_t>(node_count_ - 1) };
+		while (!stack.empty()) {
+			auto& nd = nodes_[stack.back()];
+			stack.pop_back();
+			if (!nd.box_.intersects(seg))
+				continue;
+			for (std::uint32_t i = nd.first_; i < nd.first_ + nd.count_; ++i) {
+				if (!nd.leaf_)
+					stack.push_back(i);
+				else if (seg_box.intersects(aabb2d(segs_[i])) && crossing(seg, segs_[i]) != segment_crossing::none)
+					out.push_back(ids_[i]);
+			}
+		}
+	}
+
+	std::vector<std::pair<std::uint32_t, double>> rtree::nearest(const point2d& p, std::size_t k) const {
+		std::vector<std::pair<std::uint32_t, double>> ans;
+		if (node_count_ == 0 || k == 0)
+			return ans;
+		// 最小堆: (距离的平方, 下标, 是否是线段). 弹出的线段一定比堆中剩下的都近
+		using item = std::tuple<double, std::uint32_t, bool>;
+		std::priority_queue<item, std::vector<item>, std::greater<item>> heap;
+		heap.emplace(0.0, static_cast<std::uint32_t>(node_count_ - 1), false);
+		while (!heap.empty() && ans.size() < k) {
+			auto top = heap.top();
+			heap.pop();
+			auto idx = std::get<1>(top);
+			if (std::get<2>(top)) {
+				ans.emplace_back(ids_[idx], std::get<0>(top));
+				continue;
+			}
+			auto& nd = nodes_[idx];
+			for (std::uint32_t i = nd.first_; i < nd.first_ + nd.count_; ++i) {
+				if (nd.leaf_)
+					heap.emplace(distance2(p, segs_[i]), i, true);
+				else
+					heap.emplace(nodes_[i].box_.distance2(p), i, false);
+			}
+		}
+		return ans;
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <geo/aabb2d.h>
+#include <geo/segment2d.h>
+#include <util/mapped_file.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace geo {
+	/// <summary>
+	/// 静态的R-tree, 用Sort-Tile-Recursive(STR)一次性建立, 建好后不能修改.
+	/// 1. 节点保存在一个数组中: 先是所有叶子, 然后逐层向上, 最后一个是根. 子节点是连续的, 只保存起点和个数
+	/// 2. 线段按叶子的顺序重新排列并复制一份, 查询时顺序访问; ids()是排列后到原始下标的映射
+	/// 3. 所有数据放在一块连续内存中. save()原样写入文件, load()用mmap直接使用. 文件使用本机字节序
+	/// 线段个数不能超过UINT32_MAX
+	/// </summary>
+	class rtree {
+	public:
+		// 每个节点最多的子节点个数
+		static constexpr std::size_t fanout_ = 16;
+
+		struct node {
+			aabb2d box_;
+			std::uint32_t first_;  // 叶子: 第一条线段的位置; 内部节点: 第一个子节点的位置
+			std::uint16_t count_;
+			std::uint16_t leaf_;   // 1表示叶子
+		};
+
+	public:
+		rtree() {
+
+		}
+		// threads是建立时使用的线程数, 0表示std::thread::hardware_concurrency()
+		explicit rtree(const std::vector<segment2d>& segs, unsigned threads = 0) {
+			build(segs, threads);
+		}
+		~rtree() {
+			clear();
+		}
+		rtree(const rtree&) = delete;
+		rtree& operator=(const rtree&) = delete;
+
+		void build(const std::vector<segment2d>& segs, unsigned threads = 0);
+		void clear();
+
+		// 写入文件. 失败返回false
+		bool save(const std::string& path) const;
+		// 映射save()生成的文件. 文件不存在或格式不对时返回false, 树变为空.
+		// 加载时检查每个节点的子节点范围和ids()不越界(O(n)), 损坏的文件也返回false
+		bool load(const std::string& path);
+
+		/// <summary>
+		/// 和box有公共点的线段, 把原始下标追加到out. 顺序不确定
+		/// </summary>
+		void query_box(const aabb2d& box, std::vector<std::uint32_t>& out) const;
+		/// <summary>
+		/// 和seg有公共点的线段(包括端点接触和共线重叠), 用geo::crossing精确判断
+		/// </summary>
+		void query_segment(const segment2d& seg, std::vector<std::uint32_t>& out) const;
+		/// <summary>
+		/// 离p最近的k条线段, 返回(原始下标, 距离的平方), 按距离从小到大
+		/// </summary>
+		std::vector<std::pair<std::uint32_t, double>> nearest(const point2d& p, std::size_t k) const;
+
+		std::size_t size() const {
+			return size_;
+		}
+		std::size_t node_count() const {
+			return node_count_;
+		}
+		const node* nodes() const {
+			return nodes_;
+		}
+		// 按叶子顺序排列的线段, ids()[i]是segments()[i]的原始下标
+		const segment2d* segments() const {
+			return segs_;
+		}
+		const std::uint32_t* ids() const {
+			return ids_;
+		}
+
+	private:
+		// 按照data中的布局设置各个数组的指针. 布局不合法或节点的下标越界时返回false
+		bool attach(const unsigned char* data, std::size_t bytes);
+
+	private:
+		const unsigned char* data_ = nullptr;  // 文件头, 后面是各个数组
+		std::size_t size_ = 0;
+		std::size_t node_count_ = 0;
+		const node* nodes_ = nullptr;
+		const segment2d* segs_ = nullptr;
+		const std::uint32_t* ids_ = nullptr;
+
+		// build()的数据, 按8字节对齐
+		std::vector<std::uint64_t> storage_;
+		// load()的映射
+		wzj::mapped_file file_;
+	};
+}
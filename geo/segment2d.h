@@ -2,52 +2,95 @@
 
 #include <geo/point2d.h>
 
+#include <type_traits>
 #include <utility>
 
 namespace geo {
-	struct segment2d {
+	// T是坐标类型, 见basic_point2d
+	template <typename T>
+	struct basic_segment2d {
+		using point_type = basic_point2d<T>;
 
-		segment2d() {
+		basic_segment2d() {
 
 		}
-		segment2d(const point2d& st, const point2d& en) : st_(st), en_(en) {
+		basic_segment2d(const point_type& st, const point_type& en) : st_(st), en_(en) {
 
 		}
 
 		// 斜率
 		double k() const {
-			return (en_.y_ - st_.y_) / (en_.x_ - st_.x_);
+			return (double(en_.y_) - st_.y_) / (double(en_.x_) - st_.x_);
 		}
 
 		/// <summary>
 		/// 根据x计算y. 如果垂直, 返回低y
 		/// </summary>
 		double calc_y(double x) const {
-			return (x - st_.x_) / (en_.x_ - st_.x_) * (en_.y_ - st_.y_) + st_.y_;
+			return (x - st_.x_) / (double(en_.x_) - st_.x_) * (double(en_.y_) - st_.y_) + st_.y_;
 		}
 		/// <summary>
 		/// 根据y计算x. 如果水平, 返回左x
 		/// </summary>
 		double calc_x(double y) const {
-			return (y - st_.y_) / (en_.y_ - st_.y_) * (en_.x_ - st_.x_) + st_.x_;
+			return (y - st_.y_) / (double(en_.y_) - st_.y_) * (double(en_.x_) - st_.x_) + st_.x_;
 		}
 
 		bool is_point(double tol) const {
-			return std::fabs(st_.x_ - en_.x_) < tol && std::fabs(st_.y_ - en_.y_) < tol;
+			return std::fabs(double(st_.x_) - en_.x_) < tol && std::fabs(double(st_.y_) - en_.y_) < tol;
 		}
 		bool is_hori(double tol) const {
-			return std::fabs(st_.y_ - en_.y_) < tol;
+			return std::fabs(double(st_.y_) - en_.y_) < tol;
 		}
 		bool is_vert(double tol) const {
-			return std::fabs(st_.x_ - en_.x_) < tol;
+			return std::fabs(double(st_.x_) - en_.x_) < tol;
 		}
 
 		// return.second == true表示在线段内(包括端点), 否则表示在线段外或平行无交点
-		// ignore_end==true表示忽略交点是端点的情况
-		std::pair<point2d, bool> intersect(const segment2d& other, double tol, bool ignore_end = false) const;
+		// ignore_end==true表示忽略交点是端点的情况.
+		// 只用于浮点坐标. 整数坐标用geo::crossing精确判断, 见predicates.h
+		std::pair<point_type, bool> intersect(const basic_segment2d& other, double tol, bool ignore_end = false) const;
 
-		point2d st_;
-		point2d en_;
+		point_type st_;
+		point_type en_;
 	};
 
-}
\ No newline at end of file
+	using segment2d = basic_segment2d<double>;
+	using segment2df = basic_segment2d<float>;
+	using segment2di = basic_segment2d<std::int32_t>;
+
+	template <typename T>
+	std::pair<typename basic_segment2d<T>::point_type, bool> basic_segment2d<T>::intersect(
+		const basic_segment2d& other, double tol, bool ignore_end) const {
+		static_assert(std::is_floating_point<T>::value, "use geo::crossing for integer segments");
+
+		std::pair<point_type, bool> ans = {};
+
+		auto d0 = en_ - st_, d1 = other.en_ - other.st_;
+		if (!d0.is_parallel(d1, tol)) {
+			auto v = other.st_ - st_;
+			double cross = d0.cross(d1);
+			T s = T((v.x_ * d1.y_ - v.y_ * d1.x_) / cross);
+
+			ans.first = st_ + s * d0;
+			ans.second = (s > 0 && s < 1) ||
+				(!ignore_end && ((ans.first - st_).is_zero(tol) || (ans.first - en_).is_zero(tol)));
+
+			if (ans.second == true) {
+				if (!ignore_end && ((ans.first - other.st_).is_zero(tol) || (ans.first - other.en_).is_zero(tol)))
+					ans.second = true;
+				else {
+					ans.second = 
+						(other.is_vert(tol) || ((ans.first.x_ > other.st_.x_) != (ans.first.x_ > other.en_.x_))) &&
+						(other.is_hori(tol) || ((ans.first.y_ > other.st_.y_) != (ans.first.y_ > other.en_.y_)));
+				}
+			}
+		}
+
+		return ans;
+	}
+
+	// 在segment2d.cpp中实例化
+	extern template struct basic_segment2d<float>;
+	extern template struct basic_segment2d<double>;
+}
@@ -0,0 +1,124 @@
+#include <geo/segment2d_batch.h>
+
+// 编译期选择: AVX(4个double) > SSE2(2个double) > 标量
+#if defined(__AVX__)
+#include <immintrin.h>
+#define GEO_SIMD_WIDTH 4
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GEO_SIMD_WIDTH 2
+#endif
+
+namespace geo {
+#if GEO_SIMD_WIDTH == 4
+	namespace {
+		using vec = __m256d;
+		inline vec load(const double* p) { return _mm256_loadu_pd(p); }
+		inline void store(double* p, vec a) { _mm256_storeu_pd(p, a); }
+		inline vec set1(double x) { return _mm256_set1_pd(x); }
+		inline vec add(vec a, vec b) { return _mm256_add_pd(a, b); }
+		inline vec sub(vec a, vec b) { return _mm256_sub_pd(a, b); }
+		inline vec mul(vec a, vec b) { return _mm256_mul_pd(a, b); }
+		inline vec div(vec a, vec b) { return _mm256_div_pd(a, b); }
+		inline vec and_(vec a, vec b) { return _mm256_and_pd(a, b); }
+		inline vec or_(vec a, vec b) { return _mm256_or_pd(a, b); }
+		inline vec xor_(vec a, vec b) { return _mm256_xor_pd(a, b); }
+		inline vec andnot(vec a, vec b) { return _mm256_andnot_pd(a, b); }  // ~a & b
+		inline vec lt(vec a, vec b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+		inline vec gt(vec a, vec b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+		inline int movemask(vec a) { return _mm256_movemask_pd(a); }
+		inline vec all_ones() { vec z = _mm256_setzero_pd(); return _mm256_cmp_pd(z, z, _CMP_EQ_OQ); }
+	}
+#elif GEO_SIMD_WIDTH == 2
+	namespace {
+		using vec = __m128d;
+		inline vec load(const double* p) { return _mm_loadu_pd(p); }
+		inline void store(double* p, vec a) { _mm_storeu_pd(p, a); }
+		inline vec set1(double x) { return _mm_set1_pd(x); }
+		inline vec add(vec a, vec b) { return _mm_add_pd(a, b); }
+		inline vec sub(vec a, vec b) { return _mm_sub_pd(a, b); }
+		inline vec mul(vec a, vec b) { return _mm_mul_pd(a, b); }
+		inline vec div(vec a, vec b) { return _mm_div_pd(a, b); }
+		inline vec and_(vec a, vec b) { return _mm_and_pd(a, b); }
+		inline vec or_(vec a, vec b) { return _mm_or_pd(a, b); }
+		inline vec xor_(vec a, vec b) { return _mm_xor_pd(a, b); }
+		inline vec andnot(vec a, vec b) { return _mm_andnot_pd(a, b); }  // ~a & b
+		inline vec lt(vec a, vec b) { return _mm_cmplt_pd(a, b); }
+		inline vec gt(vec a, vec b) { return _mm_cmpgt_pd(a, b); }
+		inline int movemask(vec a) { return _mm_movemask_pd(a); }
+		inline vec all_ones() { vec z = _mm_setzero_pd(); return _mm_cmpeq_pd(z, z); }
+	}
+#endif
+
+	std::size_t segment2d_batch::intersect(const segment2d& seg, double tol, bool ignore_end,
+		std::vector<std::uint64_t>& hits, std::vector<point2d>* points) const {
+
+		auto n = size();
+		hits.assign((n + 63) / 64, 0);
+		if (points)
+			points->resize(n);
+		std::size_t cnt = 0;
+		std::size_t i = 0;
+
+#ifdef GEO_SIMD_WIDTH
+		// 和segment2d::intersect相同的运算顺序. 分支改成掩码
+		const vec sign = set1(-0.0);
+		const vec vtol = set1(tol);
+		const vec zero = set1(0.0), one = set1(1.0);
+		const vec check_end = ignore_end ? zero : all_ones();
+		const vec stx = set1(seg.st_.x_), sty = set1(seg.st_.y_);
+		const vec enx = set1(seg.en_.x_), eny = set1(seg.en_.y_);
+		const vec d0x = set1(seg.en_.x_ - seg.st_.x_), d0y = set1(seg.en_.y_ - seg.st_.y_);
+		auto abs_lt_tol = [&](vec a) { return lt(andnot(sign, a), vtol); };
+		auto near = [&](vec ax, vec ay, vec bx, vec by) {
+			return and_(abs_lt_tol(sub(ax, bx)), abs_lt_tol(sub(ay, by)));
+		};
+
+		for (; i + GEO_SIMD_WIDTH <= n; i += GEO_SIMD_WIDTH) {
+			vec cstx = load(&st_x_[i]), csty = load(&st_y_[i]);
+			vec cenx = load(&en_x_[i]), ceny = load(&en_y_[i]);
+			vec d1x = sub(cenx, cstx), d1y = sub(ceny, csty);
+			vec cross = sub(mul(d0x, d1y), mul(d0y, d1x));
+			vec parallel = abs_lt_tol(cross);
+
+			vec vx = sub(cstx, stx), vy = sub(csty, sty);
+			vec s = div(sub(mul(vx, d1y), mul(vy, d1x)), cross);
+			vec px = add(stx, mul(s, d0x)), py = add(sty, mul(s, d0y));
+
+			// 在seg内
+			vec hit = or_(and_(gt(s, zero), lt(s, one)),
+				and_(check_end, or_(near(px, py, stx, sty), near(px, py, enx, eny))));
+			// 在另一条线段内
+			vec on_end = and_(check_end, or_(near(px, py, cstx, csty), near(px, py, cenx, ceny)));
+			vec in_x = or_(abs_lt_tol(d1x), xor_(gt(px, cstx), gt(px, cenx)));
+			vec in_y = or_(abs_lt_tol(d1y), xor_(gt(py, csty), gt(py, ceny)));
+			hit = andnot(parallel, and_(hit, or_(on_end, and_(in_x, in_y))));
+
+			if (points) {
+				alignas(32) double xs[GEO_SIMD_WIDTH], ys[GEO_SIMD_WIDTH];
+				store(xs, andnot(parallel, px));
+				store(ys, andnot(parallel, py));
+				for (int k = 0; k < GEO_SIMD_WIDTH; ++k)
+					(*points)[i + k] = { xs[k], ys[k] };
+			}
+			auto mask = static_cast<std::uint64_t>(movemask(hit));
+			if (mask) {
+				hits[i / 64] |= mask << (i % 64);
+				for (; mask; mask &= mask - 1)
+					++cnt;
+			}
+		}
+#endif
+		// 剩余部分, 或者没有SIMD时
+		for (; i < n; ++i) {
+			auto r = seg.intersect((*this)[i], tol, ignore_end);
+			if (points)
+				(*points)[i] = r.first;
+			if (r.second) {
+				hits[i / 64] |= std::uint64_t(1) << (i % 64);
+				++cnt;
+			}
+		}
+		return cnt;
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <geo/segment2d.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace geo {
+	// 按SoA保存的一组线段, 用于一条线段和大量线段求交.
+	// 每个坐标分量是一个连续数组, 可以用SIMD一次处理多条线段(AVX 4条, SSE2 2条, 否则逐条)
+	struct segment2d_batch {
+
+		segment2d_batch() {
+
+		}
+		explicit segment2d_batch(const std::vector<segment2d>& segs) {
+			reserve(segs.size());
+			for (auto& s : segs)
+				push_back(s);
+		}
+
+		void push_back(const segment2d& s) {
+			st_x_.push_back(s.st_.x_);
+			st_y_.push_back(s.st_.y_);
+			en_x_.push_back(s.en_.x_);
+			en_y_.push_back(s.en_.y_);
+		}
+		void reserve(std::size_t n) {
+			st_x_.reserve(n);
+			st_y_.reserve(n);
+			en_x_.reserve(n);
+			en_y_.reserve(n);
+		}
+		void clear() {
+			st_x_.clear();
+			st_y_.clear();
+			en_x_.clear();
+			en_y_.clear();
+		}
+		std::size_t size() const {
+			return st_x_.size();
+		}
+		segment2d operator[](std::size_t i) const {
+			return { {st_x_[i], st_y_[i]}, {en_x_[i], en_y_[i]} };
+		}
+
+		/// <summary>
+		/// 对每个i计算seg.intersect((*this)[i], tol, ignore_end), 运算顺序和逐条调用相同.
+		/// hits的第i位表示是否相交, 大小会被调整为(size()+63)/64. 
+		/// points不为空时, (*points)[i]是交点(平行时是(0,0)), 大小会被调整为size(). 
+		/// 返回相交的个数
+		/// </summary>
+		std::size_t intersect(const segment2d& seg, double tol, bool ignore_end,
+			std::vector<std::uint64_t>& hits, std::vector<point2d>* points = nullptr) const;
+
+		std::vector<double> st_x_;
+		std::vector<double> st_y_;
+		std::vector<double> en_x_;
+		std::vector<double> en_y_;
+	};
+}
@@ -1,6 +1,20 @@
 #include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <random>
+#include <vector>
 
+#include <geo/bounded_segment2d.h>
+#include <geo/kdtree.h>
+#include <geo/point_hash_set.h>
+#include <geo/predicates.h>
+#include <geo/rtree.h>
 #include <geo/segment2d.h>
+#include <geo/segment2d_batch.h>
 
 namespace geo {
 	void test_segment() {
@@ -32,8 +46,406 @@ namespace geo {
 		ipt = s1.intersect({ {9,12},{13,8} }, tol);
 		assert(ipt.second == false);
 	}
+
+	// 和逐条调用segment2d::intersect比较. 允许编译器把乘加合并成FMA, 所以交点只要求在tol以内
+	void test_segment_batch() {
+		double tol = 1e-6;
+		std::mt19937 rng(7);
+		// 坐标取在小的整数网格上, 容易出现平行, 端点重合, 水平和垂直的情况
+		std::uniform_int_distribution<int> coord(0, 8);
+		auto random_segment = [&]() {
+			return geo::segment2d{ {coord(rng) * 0.5, coord(rng) * 0.5}, {coord(rng) * 0.5, coord(rng) * 0.5} };
+		};
+		for (int epoch = 0; epoch < 200; ++epoch) {
+			std::vector<geo::segment2d> segs;
+			int n = epoch % 70;
+			for (int i = 0; i < n; ++i)
+				segs.push_back(random_segment());
+			geo::segment2d_batch batch(segs);
+			assert(batch.size() == segs.size());
+			auto q = random_segment();
+			for (bool ignore_end : { false, true }) {
+				std::vector<std::uint64_t> hits;
+				std::vector<geo::point2d> points;
+				auto cnt = batch.intersect(q, tol, ignore_end, hits, &points);
+				assert(hits.size() == (segs.size() + 63) / 64 && points.size() == segs.size());
+				std::size_t expect_cnt = 0;
+				for (std::size_t i = 0; i < segs.size(); ++i) {
+					auto expect = q.intersect(segs[i], tol, ignore_end);
+					bool hit = (hits[i / 64] >> (i % 64)) & 1;
+					assert(hit == expect.second);
+					assert((points[i] - expect.first).is_zero(tol));
+					expect_cnt += expect.second;
+				}
+				assert(cnt == expect_cnt);
+				assert(batch.intersect(q, tol, ignore_end, hits) == expect_cnt);
+			}
+		}
+	}
+
+	// 在2^-53的网格上, 用整数精确计算符号
+	void test_orient2d() {
+		const double ulp = std::ldexp(1.0, -53);
+		auto exact_sign = [&](const geo::point2d& a, const geo::point2d& b, const geo::point2d& c) {
+			auto to_int = [&](double v) { return static_cast<std::int64_t>(v / ulp); };
+			return geo::detail::product_diff_sign(to_int(a.x_) - to_int(c.x_), to_int(b.y_) - to_int(c.y_),
+				to_int(a.y_) - to_int(c.y_), to_int(b.x_) - to_int(c.x_));
+		};
+		auto sign = [](double v) { return (v > 0) - (v < 0); };
+
+		// 几乎共线的点, double直接计算会给出错误的符号
+		geo::point2d b(12, 12), c(24, 24);
+		int wrong_naive = 0;
+		for (int i = 0; i < 64; ++i)
+			for (int j = 0; j < 64; ++j) {
+				geo::point2d a(0.5 + i * ulp, 0.5 + j * ulp);
+				int expect = exact_sign(a, b, c);
+				assert(sign(geo::orient2d(a, b, c)) == expect);
+				double naive = (a.x_ - c.x_) * (b.y_ - c.y_) - (a.y_ - c.y_) * (b.x_ - c.x_);
+				wrong_naive += sign(naive) != expect;
+			}
+		assert(wrong_naive > 0);
+
+		std::mt19937 rng(11);
+		std::uniform_int_distribution<int> coord(-1000, 1000);
+		for (int i = 0; i < 10000; ++i) {
+			geo::point2d a(coord(rng) / 64.0, coord(rng) / 64.0), b2(coord(rng) / 64.0, coord(rng) / 64.0);
+			geo::point2d c2 = i % 2 ? a + (b2 - a) * 3.0 : geo::point2d(coord(rng) / 64.0, coord(rng) / 64.0);
+			assert(sign(geo::orient2d(a, b2, c2)) == exact_sign(a, b2, c2));
+		}
+	}
+
+	void test_crossing() {
+		using geo::segment_crossing;
+		geo::segment2d s1{ {0,0},{10,10} };
+		assert(geo::crossing(s1, { {0,10},{10,0} }) == segment_crossing::proper);
+		assert(geo::crossing(s1, { {10,10},{20,0} }) == segment_crossing::touch);
+		assert(geo::crossing(s1, { {5,5},{20,0} }) == segment_crossing::touch);
+		assert(geo::crossing(s1, { {5,5},{20,20} }) == segment_crossing::overlap);
+		assert(geo::crossing(s1, { {10,10},{20,20} }) == segment_crossing::touch);
+		assert(geo::crossing(s1, { {11,11},{20,20} }) == segment_crossing::none);
+		assert(geo::crossing(s1, { {0,1},{10,11} }) == segment_crossing::none);
+		assert(geo::crossing(s1, { {3,3},{3,3} }) == segment_crossing::touch);
+		assert(geo::segments_intersect(s1, { {10,10},{20,0} }));
+		assert(!geo::segments_intersect(s1, { {10,10},{20,0} }, true));
+
+		// 不平行时和segment2d::intersect一致. 坐标是小整数, tol足够小时segment2d::intersect也是精确的.
+		// segment2d::intersect的ignore_end只忽略自身的端点, 所以不和proper比较
+		std::mt19937 rng(13);
+		std::uniform_int_distribution<int> coord(0, 6);
+		for (int i = 0; i < 20000; ++i) {
+			geo::segment2d a{ {double(coord(rng)), double(coord(rng))}, {double(coord(rng)), double(coord(rng))} };
+			geo::segment2d b{ {double(coord(rng)), double(coord(rng))}, {double(coord(rng)), double(coord(rng))} };
+			if (a.is_point(0.5) || b.is_point(0.5) || (a.en_ - a.st_).is_parallel(b.en_ - b.st_, 0.5))
+				continue;
+			auto r = geo::crossing(a, b);
+			assert((r != segment_crossing::none) == a.intersect(b, 1e-9).second);
+		}
+	}
+
+	// 整数和float坐标. 整数坐标的谓词不需要tol, 坐标接近int32范围时谓词也不会溢出.
+	// 点的加减乘结果仍是int32, 只在结果不超出int32范围时使用
+	void test_coord_types() {
+		static_assert(sizeof(geo::segment2d) == 32, "");
+		static_assert(sizeof(geo::segment2df) == 16 && sizeof(geo::segment2di) == 16, "");
+		using geo::segment_crossing;
+		const std::int32_t big = 2000000000;
+		geo::point2di a(-big, -big), b(big, big), c(big - 1, big);
+		assert(geo::orient2d_sign(a, b, c) > 0);
+		assert(geo::orient2d_sign(a, b, geo::point2di(0, 0)) == 0);
+		assert((b - geo::point2di(1, 1)).cross(b) == 0);
+		assert(geo::point2di(big, -1) - geo::point2di(-147483647, 0) == geo::point2di(INT32_MAX, -1));
+		assert(geo::point2di(big, -big) + geo::point2di(-big, big) == geo::point2di(0, 0));
+		assert(geo::point2di(big, 1).is_parallel(geo::point2di(big, 1)));
+		assert(geo::point2di(big, -big).length2() == 2 * std::int64_t(big) * big);
+
+		// 不依赖128位整数的路径
+		auto d = [](std::int32_t u, std::int32_t v) { return std::int64_t(u) - v; };
+		assert(geo::detail::product_diff_sign(d(a.x_, c.x_), d(b.y_, c.y_), d(a.y_, c.y_), d(b.x_, c.x_)) > 0);
+		assert(geo::detail::product_diff_sign(INT64_MIN, -1, INT64_MAX, 1) > 0);
+		assert(geo::detail::product_diff_sign(INT64_MIN, INT64_MIN, INT64_MIN, INT64_MIN) == 0);
+		assert(geo::detail::product_diff_sign(0, 5, -1, 1) > 0 && geo::detail::product_diff_sign(-3, 5, 0, 1) < 0);
+		std::mt19937_64 rng64(21);
+		for (int i = 0; i < 10000; ++i) {
+			std::int64_t v[4];
+			for (auto& x : v)
+				x = static_cast<std::int64_t>(rng64()) >> (rng64() % 64);
+			int got = geo::detail::product_diff_sign(v[0], v[1], v[2], v[3]);
+#if defined(__SIZEOF_INT128__)
+			__extension__ typedef __int128 i128;
+			i128 det = i128(v[0]) * v[1] - i128(v[2]) * v[3];
+			assert(got == (det > 0) - (det < 0));
+#endif
+			// 交换两个乘积, 符号相反
+			assert(got == -geo::detail::product_diff_sign(v[2], v[3], v[0], v[1]));
+		}
+
+		geo::segment2di s1{ a, b };
+		assert(geo::crossing(s1, geo::segment2di{ {-big, big}, {big, -big} }) == segment_crossing::proper);
+		assert(geo::crossing(s1, geo::segment2di{ {0, 0}, {big, -big} }) == segment_crossing::touch);
+		assert(geo::crossing(s1, geo::segment2di{ {0, 0}, {big, big} }) == segment_crossing::overlap);
+		assert(geo::crossing(s1, geo::segment2di{ {0, 1}, {big - 1, big} }) == segment_crossing::none);
+
+		// 小整数上, 三种坐标类型给出相同的结果
+		std::mt19937 rng(17);
+		std::uniform_int_distribution<int> coord(-4, 4);
+		for (int i = 0; i < 5000; ++i) {
+			int v[8];
+			for (auto& x : v)
+				x = coord(rng);
+			geo::segment2di p{ {v[0], v[1]}, {v[2], v[3]} }, q{ {v[4], v[5]}, {v[6], v[7]} };
+			geo::segment2d pd{ geo::point2d(p.st_), geo::point2d(p.en_) }, qd{ geo::point2d(q.st_), geo::point2d(q.en_) };
+			geo::segment2df pf{ geo::point2df(p.st_), geo::point2df(p.en_) }, qf{ geo::point2df(q.st_), geo::point2df(q.en_) };
+			auto r = geo::crossing(p, q);
+			assert(r == geo::crossing(pd, qd) && r == geo::crossing(pf, qf));
+			auto hit = pd.intersect(qd, 1e-9);
+			auto hitf = pf.intersect(qf, 1e-6);
+			assert(hit.second == hitf.second);
+		}
+	}
+
+	// 和逐条检查比较
+	void test_rtree() {
+		std::mt19937 rng(19);
+		std::uniform_real_distribution<double> pos(0, 1000), len(-20, 20);
+		auto random_segment = [&]() {
+			geo::point2d st(pos(rng), pos(rng));
+			return geo::segment2d{ st, st + geo::point2d(len(rng), len(rng)) };
+		};
+		// 线段和盒子有公共点: 端点在盒子内, 或者和盒子的某条边相交
+		auto hits_box = [](const geo::segment2d& s, const geo::aabb2d& b) {
+			if (b.contains(s.st_) || b.contains(s.en_))
+				return true;
+			geo::point2d c[4] = { {b.min_x_, b.min_y_}, {b.max_x_, b.min_y_}, {b.max_x_, b.max_y_}, {b.min_x_, b.max_y_} };
+			for (int i = 0; i < 4; ++i)
+				if (geo::segments_intersect(s, geo::segment2d{ c[i], c[(i + 1) % 4] }))
+					return true;
+			return false;
+		};
+		std::string path = "test_geo_rtree.idx";
+		for (int n : { 0, 1, 15, 16, 17, 300, 5000 }) {
+			std::vector<geo::segment2d> segs;
+			for (int i = 0; i < n; ++i)
+				segs.push_back(random_segment());
+			geo::rtree tree(segs, 1 + n % 4);
+			assert(tree.size() == segs.size());
+			assert(tree.save(path));
+			geo::rtree loaded;
+			assert(loaded.load(path) && loaded.size() == segs.size() && loaded.node_count() == tree.node_count());
+
+			for (int q = 0; q < 50; ++q) {
+				geo::point2d a(pos(rng), pos(rng));
+				geo::aabb2d box(a.x_, a.y_, a.x_ + len(rng) + 20, a.y_ + len(rng) + 20);
+				std::vector<std::uint32_t> expect, got;
+				for (int i = 0; i < n; ++i)
+					if (hits_box(segs[i], box))
+						expect.push_back(i);
+				tree.query_box(box, got);
+				std::sort(got.begin(), got.end());
+				assert(got == expect);
+
+				auto qs = random_segment();
+				expect.clear();
+				got.clear();
+				for (int i = 0; i < n; ++i)
+					if (geo::segments_intersect(qs, segs[i]))
+						expect.push_back(i);
+				loaded.query_segment(qs, got);
+				std::sort(got.begin(), got.end());
+				assert(got == expect);
+
+				// 最近的k条, 比较距离
+				std::size_t k = 1 + q % 10;
+				std::vector<double> dist;
+				for (auto& s : segs) {
+					auto d = s.en_ - s.st_;
+					double t = std::max(0.0, std::min(1.0, (a - s.st_).dot(d) / d.length2()));
+					dist.push_back((s.st_ + d * t - a).length2());
+				}
+				std::sort(dist.begin(), dist.end());
+				auto near = tree.nearest(a, k);
+				assert(near.size() == std::min<std::size_t>(k, n));
+				for (std::size_t i = 0; i < near.size(); ++i)
+					assert(std::fabs(near[i].second - dist[i]) < 1e-9);
+			}
+		}
+		geo::rtree bad;
+		assert(!bad.load(path + ".missing"));
+
+		// 格式正确但节点损坏的文件: 子节点个数超过fanout_, 或者根的子节点范围包含它自己
+		std::vector<geo::segment2d> segs;
+		for (int i = 0; i < 300; ++i)
+			segs.push_back(random_segment());
+		geo::rtree tree(segs, 1);
+		assert(tree.save(path) && bad.load(path) && bad.node_count() > 1);
+		std::vector<char> bytes;
+		std::FILE* f = std::fopen(path.c_str(), "rb");
+		for (int ch; (ch = std::fgetc(f)) != EOF;)
+			bytes.push_back(static_cast<char>(ch));
+		std::fclose(f);
+		// 32字节的文件头后面是节点数组
+		const std::size_t nodes_offset = 32, root = tree.node_count() - 1;
+		auto patch = [&](std::size_t node_idx, std::size_t field_offset, const void* value, std::size_t n) {
+			auto patched = bytes;
+			std::memcpy(patched.data() + nodes_offset + node_idx * sizeof(geo::rtree::node) + field_offset, value, n);
+			f = std::fopen(path.c_str(), "wb");
+			std::fwrite(patched.data(), 1, patched.size(), f);
+			std::fclose(f);
+			assert(!bad.load(path) && bad.size() == 0);
+		};
+		std::uint16_t count = geo::rtree::fanout_ + 1;
+		patch(0, offsetof(geo::rtree::node, count_), &count, sizeof(count));
+		auto first = static_cast<std::uint32_t>(root);
+		patch(root, offsetof(geo::rtree::node, first_), &first, sizeof(first));
+		std::remove(path.c_str());
+	}
+	void test_kdtree() {
+		std::mt19937 rng(23);
+		std::uniform_real_distribution<double> pos(0, 100);
+		for (int n : { 0, 1, 2, 7, 1000 }) {
+			std::vector<geo::point2d> pts;
+			for (int i = 0; i < n; ++i)
+				pts.emplace_back(pos(rng), pos(rng));
+			// 重复的点和同一条竖线上的点
+			for (int i = 0; i < n / 10; ++i) {
+				pts.push_back(pts[i]);
+				pts.emplace_back(50.0, pos(rng));
+			}
+			geo::kdtree tree(pts);
+			assert(tree.size() == pts.size());
+
+			std::vector<geo::point2d> qs;
+			for (int q = 0; q < 100; ++q)
+				qs.emplace_back(pos(rng), pos(rng));
+			std::size_t k = 5;
+			std::vector<std::uint32_t> ids, snap;
+			std::vector<double> dist2;
+			std::vector<std::vector<std::uint32_t>> balls;
+			tree.nearest_batch(qs, k, ids, dist2, 3);
+			tree.snap_batch(qs, 3.0, snap, 3);
+			tree.radius_batch(qs, 8.0, balls, 3);
+			for (std::size_t q = 0; q < qs.size(); ++q) {
+				std::vector<double> dist;
+				std::vector<std::uint32_t> expect;
+				for (std::size_t i = 0; i < pts.size(); ++i) {
+					dist.push_back((pts[i] - qs[q]).length2());
+					if (dist.back() <= 64.0)
+						expect.push_back(static_cast<std::uint32_t>(i));
+				}
+				auto sorted = dist;
+				std::sort(sorted.begin(), sorted.end());
+				for (std::size_t j = 0; j < k; ++j) {
+					if (j < sorted.size()) {
+						assert(dist2[q * k + j] == sorted[j] && dist[ids[q * k + j]] == sorted[j]);
+					}
+					else {
+						assert(ids[q * k + j] == geo::kdtree::npos);
+					}
+				}
+				auto one = tree.nearest(qs[q]);
+				assert(pts.empty() ? one.first == geo::kdtree::npos : one.second == sorted[0]);
+				if (!sorted.empty() && sorted[0] <= 9.0)
+					assert(dist[snap[q]] == sorted[0]);
+				else
+					assert(snap[q] == geo::kdtree::npos);
+				std::sort(balls[q].begin(), balls[q].end());
+				assert(balls[q] == expect);
+			}
+		}
+	}
+	void test_point_hash_set() {
+		geo::point_hash_set set(0.1);
+		assert(set.insert({ 0, 0 }) == std::make_pair(0u, true));
+		// 格子边界两侧的点
+		assert(set.insert({ 0.05, -0.05 }) == std::make_pair(0u, false));
+		assert(set.insert({ 0.1, 0 }) == std::make_pair(1u, true));
+		// 和两个点都重合时, 取最近的
+		assert(set.find({ 0.06, 0 }) == 1 && set.find({ 0.04, 0 }) == 0);
+		assert(set.find({ 0, 0.1 }) == geo::point_hash_set::npos && !set.contains({ -0.1, 0 }));
+		assert(set.insert({ -1e300, 1e300 }).second && set.contains({ -1e300, 1e300 }));
+		assert(set.size() == 3);
+
+		// 和暴力结果比较: 整数网格上的点加上小扰动, 代表点两两不重合
+		std::mt19937 rng(24);
+		std::uniform_int_distribution<int> grid(-50, 50);
+		std::uniform_real_distribution<double> jitter(-1e-4, 1e-4);
+		double tol = 1e-3;
+		geo::point_hash_set pts(tol);
+		std::vector<geo::point2d> reps;
+		for (int i = 0; i < 20000; ++i) {
+			geo::point2d p(grid(rng) * 0.5 + jitter(rng), grid(rng) * 0.5 + jitter(rng));
+			std::uint32_t expect = geo::point_hash_set::npos;
+			for (std::uint32_t j = 0; j < reps.size(); ++j)
+				if ((reps[j] - p).is_zero(tol)) {
+					expect = j;
+					break;
+				}
+			auto r = pts.insert(p);
+			assert(r.second == (expect == geo::point_hash_set::npos));
+			if (r.second)
+				reps.push_back(p);
+			else
+				assert(r.first == expect);
+		}
+		assert(pts.points().size() == reps.size() && reps.size() <= 101 * 101);
+	}
+	void test_aabb() {
+		geo::aabb2d a(0, 0, 2, 1), b(3, 0, 4, 1), empty;
+		assert(empty.empty() && empty.area() == 0 && !a.empty() && a.area() == 2);
+		auto u = a.united(b);
+		assert(u.min_x_ == 0 && u.max_x_ == 4 && u.area() == 4 && empty.united(a).area() == a.area());
+		assert(!a.intersects(b) && !a.intersects(b, 1.0) && a.intersects(b, 1.5) && a.inflated(0.5).intersects(b.inflated(0.5)));
+		// 穿过盒子, 只碰到角, 在盒子外
+		assert(a.intersects(geo::segment2d{ {-1, 0.5}, {3, 0.5} }));
+		assert(a.intersects(geo::segment2d{ {1, 2}, {3, 0} }));
+		assert(!a.intersects(geo::segment2d{ {1, 2.5}, {3.5, 0} }));
+		assert(!a.intersects(geo::segment2d{ {2.5, -1}, {2.5, 5} }));
+
+		// 交点离两条线段的端点都在tol以内, 包围盒的间隙大于tol
+		{
+			geo::segment2d s1{ {-10, 0}, {0, 0} }, s2{ {1.5e-3, 0.75e-3}, {10, 10} };
+			assert(s1.intersect(s2, 1e-3).second);
+			assert(geo::bounded_segment2d(s1).intersect(geo::bounded_segment2d(s2), 1e-3).second);
+		}
+
+		// 包围盒排除不改变结果
+		std::mt19937 rng(25);
+		std::uniform_real_distribution<double> pos(0, 100), len(-10, 10);
+		std::vector<geo::segment2d> segs;
+		for (int i = 0; i < 500; ++i) {
+			geo::point2d st(pos(rng), pos(rng));
+			segs.push_back({ st, st + geo::point2d(len(rng), len(rng)) });
+		}
+		// 共享端点和共线的线段
+		segs.push_back({ segs[0].en_, {50, 50} });
+		segs.push_back({ segs[1].st_, segs[1].st_ * 2 - segs[1].en_ });
+		int hits = 0;
+		for (auto& s1 : segs)
+			for (auto& s2 : segs) {
+				geo::bounded_segment2d b1(s1), b2(s2);
+				for (int c = 0; c < 4; ++c) {
+					bool ignore_end = c & 1;
+					double tol = c < 2 ? 1e-9 : 0.5;
+					auto expect = s1.intersect(s2, tol, ignore_end);
+					auto got = b1.intersect(b2, tol, ignore_end);
+					assert(got.second == expect.second);
+					if (got.second)
+						assert(got.first.x_ == expect.first.x_ && got.first.y_ == expect.first.y_);
+					hits += got.second;
+				}
+			}
+		assert(hits > 0);
+	}
 }
 
 int main() {
 	geo::test_segment();
+	geo::test_segment_batch();
+	geo::test_orient2d();
+	geo::test_crossing();
+	geo::test_coord_types();
+	geo::test_rtree();
+	geo::test_kdtree();
+	geo::test_point_hash_set();
+	geo::test_aabb();
 }
\ No newline at end of file
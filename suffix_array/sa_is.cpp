@@ -0,0 +1,120 @@
+#include <suffix_array/sa_is.h>
+
+#include <algorithm>
+
+namespace wzj {
+namespace {
+// s的元素在[0, upper]之间. 递归处理LMS子串的名字
+std::vector<std::int32_t> sa_is(const std::vector<std::int32_t>& s, std::int32_t upper) {
+  auto n = static_cast<std::int32_t>(s.size());
+  if (n == 0) return {};
+  if (n == 1) return {0};
+  if (n == 2) return s[0] < s[1] ? std::vector<std::int32_t>{0, 1} : std::vector<std::int32_t>{1, 0};
+
+  std::vector<std::int32_t> sa(n);
+  // ls[i]: 后缀i是S型(比后缀i+1小). 最后一个后缀是L型
+  std::vector<bool> ls(n);
+  for (auto i = n - 2; i >= 0; --i) ls[i] = s[i] == s[i + 1] ? ls[i + 1] : s[i] < s[i + 1];
+
+  // 桶的边界: sum_l[c]是字符c的桶的起点(L型在前), sum_s[c]是其中S型部分的起点
+  std::vector<std::int32_t> sum_l(upper + 1), sum_s(upper + 1);
+  for (std::int32_t i = 0; i < n; ++i) {
+    if (!ls[i])
+      ++sum_s[s[i]];
+    else
+      ++sum_l[s[i] + 1];
+  }
+  for (std::int32_t c = 0; c <= upper; ++c) {
+    sum_s[c] += sum_l[c];
+    if (c < upper) sum_l[c + 1] += sum_s[c];
+  }
+
+  // 从排好序的LMS后缀诱导出所有后缀的顺序
+  auto induce = [&](const std::vector<std::int32_t>& lms) {
+    std::fill(sa.begin(), sa.end(), -1);
+    std::vector<std::int32_t> buf(sum_s);
+    for (auto d : lms)
+      if (d != n) sa[buf[s[d]]++] = d;
+    // L型, 从左往右
+    buf = sum_l;
+    sa[buf[s[n - 1]]++] = n - 1;
+    for (std::int32_t i = 0; i < n; ++i) {
+      auto v = sa[i];
+      if (v >= 1 && !ls[v - 1]) sa[buf[s[v - 1]]++] = v - 1;
+    }
+    // S型, 从右往左
+    buf = sum_l;
+    for (auto i = n - 1; i >= 0; --i) {
+      auto v = sa[i];
+      if (v >= 1 && ls[v - 1]) sa[--buf[s[v - 1] + 1]] = v - 1;
+    }
+  };
+
+  // LMS位置: 左边是L型的S型位置
+  std::vector<std::int32_t> lms_map(n + 1, -1), lms;
+  for (std::int32_t i = 1; i < n; ++i)
+    if (!ls[i - 1] && ls[i]) {
+      lms_map[i] = static_cast<std::int32_t>(lms.size());
+      lms.push_back(i);
+    }
+  auto m = static_cast<std::int32_t>(lms.size());
+  induce(lms);
+  if (m == 0) return sa;
+
+  // 给LMS子串命名, 相同的子串名字相同
+  std::vector<std::int32_t> sorted_lms;
+  sorted_lms.reserve(m);
+  for (auto v : sa)
+    if (lms_map[v] != -1) sorted_lms.push_back(v);
+  std::vector<std::int32_t> rec_s(m);
+  std::int32_t rec_upper = 0;
+  rec_s[lms_map[sorted_lms[0]]] = 0;
+  for (std::int32_t i = 1; i < m; ++i) {
+    auto l = sorted_lms[i - 1], r = sorted_lms[i];
+    auto end_l = lms_map[l] + 1 < m ? lms[lms_map[l] + 1] : n;
+    auto end_r = lms_map[r] + 1 < m ? lms[lms_map[r] + 1] : n;
+    bool same = end_l - l == end_r - r;
+    if (same) {
+      while (l < end_l && s[l] == s[r]) {
+        ++l;
+        ++r;
+      }
+      if (l == n || s[l] != s[r]) same = false;
+    }
+    if (!same) ++rec_upper;
+    rec_s[lms_map[sorted_lms[i]]] = rec_upper;
+  }
+
+  // 名字都不同时递归会直接得到顺序, 否则继续递归
+  auto rec_sa = sa_is(rec_s, rec_upper);
+  for (std::int32_t i = 0; i < m; ++i) sorted_lms[i] = lms[rec_sa[i]];
+  induce(sorted_lms);
+  return sa;
+}
+}  // namespace
+
+std::vector<std::int32_t> build_suffix_array(const unsigned char* text, std::size_t n) {
+  std::vector<std::int32_t> s(text, text + n);
+  return sa_is(s, 255);
+}
+
+std::vector<std::int32_t> build_lcp(const unsigned char* text, std::size_t n,
+                                    const std::vector<std::int32_t>& sa) {
+  auto len = static_cast<std::int32_t>(n);
+  std::vector<std::int32_t> rank(len), lcp(len, 0);
+  for (std::int32_t i = 0; i < len; ++i) rank[sa[i]] = i;
+  // 按文本顺序处理后缀, h每次最多减1
+  std::int32_t h = 0;
+  for (std::int32_t i = 0; i < len; ++i) {
+    if (h > 0) --h;
+    if (rank[i] == 0) {
+      h = 0;
+      continue;
+    }
+    auto j = sa[rank[i] - 1];
+    while (i + h < len && j + h < len && text[i + h] == text[j + h]) ++h;
+    lcp[rank[i]] = h;
+  }
+  return lcp;
+}
+}  // namespace wzj
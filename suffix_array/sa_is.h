@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace wzj {
+
+// SA-IS(Nong, Zhang, Chan 2009), O(n)时间建立后缀数组.
+// sa[i]是第i小的后缀的起点. 没有追加结束符, 较短的后缀是较长后缀的前缀时排在前面.
+// 下标用int32_t, 文本长度不能超过INT32_MAX
+std::vector<std::int32_t> build_suffix_array(const unsigned char* text, std::size_t n);
+
+// Kasai算法, O(n)时间建立LCP数组.
+// lcp[i]是后缀sa[i-1]和sa[i]的最长公共前缀长度, lcp[0] = 0
+std::vector<std::int32_t> build_lcp(const unsigned char* text, std::size_t n,
+                                    const std::vector<std::int32_t>& sa);
+}  // namespace wzj
@@ -0,0 +1,149 @@
+#include <suffix_array/sa_is.h>
+#include <suffix_array/text_index.h>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std::chrono;
+typedef std::chrono::milliseconds MS;
+
+// 和直接排序比较
+void test_suffix_array() {
+  std::mt19937 rng(1);
+  for (int epoch = 0; epoch < 300; ++epoch) {
+    int n = epoch < 10 ? epoch : static_cast<int>(rng() % 500);
+    int sigma = 1 + epoch % 5 * (epoch % 7 == 0 ? 50 : 1);
+    std::string text;
+    for (int i = 0; i < n; ++i) text += static_cast<char>('a' + rng() % sigma);
+    auto s = reinterpret_cast<const unsigned char*>(text.data());
+
+    std::vector<std::int32_t> expect(n);
+    std::iota(expect.begin(), expect.end(), 0);
+    std::sort(expect.begin(), expect.end(), [&](int a, int b) {
+      return std::lexicographical_compare(s + a, s + n, s + b, s + n);
+    });
+    auto sa = wzj::build_suffix_array(s, n);
+    assert(sa == expect);
+
+    auto lcp = wzj::build_lcp(s, n, sa);
+    for (int i = 1; i < n; ++i) {
+      int h = 0;
+      while (sa[i - 1] + h < n && sa[i] + h < n && s[sa[i - 1] + h] == s[sa[i] + h]) ++h;
+      assert(lcp[i] == h);
+    }
+  }
+}
+
+// 二分和FM-index的结果和std::string::find一致, save/load之后也一致
+void test_text_index() {
+  std::mt19937 rng(2);
+  std::string path = "test_suffix_array.idx";
+  for (int epoch = 0; epoch < 40; ++epoch) {
+    std::string text;
+    int sigma = epoch % 2 ? 4 : 200;
+    int n = epoch % 10 == 0 ? static_cast<int>(rng() % 3) : 3000;
+    for (int i = 0; i < n; ++i) text += static_cast<char>(rng() % sigma + (sigma == 4 ? 'a' : 0));
+    wzj::text_index plain(text, epoch % 3 != 0, false);
+    wzj::text_index fm(text, true, true);
+    assert(!plain.has_fm() && fm.has_fm() && fm.has_lcp());
+    assert(fm.save(path));
+    wzj::text_index loaded;
+    assert(loaded.load(path) && loaded.has_fm() && loaded.size() == text.size());
+    assert(std::equal(text.begin(), text.end(), loaded.text()));
+
+    for (int q = 0; q < 50; ++q) {
+      std::string pattern;
+      int m = static_cast<int>(rng() % 8);
+      if (n > m && q % 2) {
+        pattern = text.substr(rng() % (n - m), m);
+      } else {
+        for (int i = 0; i < m; ++i) pattern += static_cast<char>(rng() % sigma + (sigma == 4 ? 'a' : 0));
+      }
+      std::vector<std::size_t> expect;
+      for (auto pos = text.find(pattern); pos != std::string::npos && pos < text.size();
+           pos = text.find(pattern, pos + 1))
+        expect.push_back(pos);
+      if (pattern.empty()) {
+        expect.resize(text.size());
+        std::iota(expect.begin(), expect.end(), 0);
+      }
+      assert(plain.locate(pattern) == expect);
+      assert(fm.locate(pattern) == expect);
+      assert(loaded.count(pattern) == expect.size());
+      assert(loaded.range(pattern) == fm.range(pattern));
+    }
+  }
+  wzj::text_index bad;
+  assert(!bad.load(path + ".missing"));
+  std::FILE* f = std::fopen(path.c_str(), "wb");
+  std::fputs("not an index", f);
+  std::fclose(f);
+  assert(!bad.load(path) && bad.size() == 0);
+  // 格式正确但内容损坏的文件: 后缀数组的值越界, 或者FM-index的c表不对
+  wzj::text_index banana(std::string("banana"), true, true);
+  assert(banana.save(path) && bad.load(path) && bad.count("ana") == 2);
+  std::vector<char> bytes;
+  f = std::fopen(path.c_str(), "rb");
+  for (int ch; (ch = std::fgetc(f)) != EOF;) bytes.push_back(static_cast<char>(ch));
+  std::fclose(f);
+  // 64字节的文件头, text占8字节, 然后是sa(24字节), lcp(24字节), c
+  const std::size_t sa_offset = 64 + 8, c_offset = sa_offset + 24 + 24;
+  for (std::size_t offset : {sa_offset + 4, c_offset}) {
+    auto patched = bytes;
+    std::int32_t value = 100;
+    std::memcpy(patched.data() + offset, &value, sizeof(value));
+    f = std::fopen(path.c_str(), "wb");
+    std::fwrite(patched.data(), 1, patched.size(), f);
+    std::fclose(f);
+    assert(!bad.load(path) && bad.size() == 0);
+  }
+  std::remove(path.c_str());
+  // 超过INT32_MAX的长度在读取文本之前就被拒绝
+  assert(bad.build("", std::size_t(INT32_MAX) + 1) == false && bad.size() == 0);
+  assert(bad.build("ab", 2) && bad.count("b") == 1);
+}
+
+// 和逐个std::string::find统计次数比较
+void test_time_compare_with_find() {
+  std::mt19937 rng(3);
+  std::string text;
+  for (int i = 0; i < 2000000; ++i) text += "ACGT"[rng() % 4];
+  std::vector<std::string> patterns;
+  for (int i = 0; i < 200; ++i) patterns.push_back(text.substr(rng() % (text.size() - 12), 12));
+
+  auto start = high_resolution_clock::now();
+  wzj::text_index index(text, false, true);
+  auto build = duration_cast<MS>(high_resolution_clock::now() - start).count();
+
+  start = high_resolution_clock::now();
+  std::size_t total = 0;
+  for (auto& p : patterns) total += index.count(p);
+  auto query = duration_cast<MS>(high_resolution_clock::now() - start).count();
+
+  start = high_resolution_clock::now();
+  std::size_t expect = 0;
+  for (auto& p : patterns)
+    for (auto pos = text.find(p); pos != std::string::npos; pos = text.find(p, pos + 1)) ++expect;
+  auto scan = duration_cast<MS>(high_resolution_clock::now() - start).count();
+  assert(total == expect);
+
+  std::cout << "text_index build(ms): " << build << ", " << patterns.size() << " queries(ms): " << query
+            << std::endl;
+  std::cout << "std::string::find(ms): " << scan << std::endl;
+}
+
+int main() {
+  test_suffix_array();
+  test_text_index();
+  test_time_compare_with_find();
+  return 0;
+}
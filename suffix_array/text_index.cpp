@@ -0,0 +1,232 @@
+#include <suffix_array/text_index.h>
+
+#include <suffix_array/sa_is.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace wzj {
+namespace {
+const char kMagic[8] = {'W', 'Z', 'J', 'S', 'A', 'I', 'X', '1'};
+const std::uint64_t kHasLcp = 1, kHasFm = 2;
+
+// 文件头, 后面依次是text, sa, lcp(可选), c, occ, bwt(后三个是FM-index, 可选). 每一段按8字节对齐
+struct header {
+  char magic[8];
+  std::uint64_t n;
+  std::uint64_t flags;
+  std::uint64_t primary;
+  std::uint64_t bytes;  // 包括文件头的总长度
+  std::uint64_t reserved[3];
+};
+
+std::size_t align8(std::size_t x) { return (x + 7) / 8 * 8; }
+
+// 各段的偏移
+struct layout {
+  layout(std::size_t n, std::uint64_t flags) {
+    text = sizeof(header);
+    sa = text + align8(n);
+    lcp = sa + align8(4 * n);
+    c = lcp + ((flags & kHasLcp) ? align8(4 * n) : 0);
+    blocks = (n + 1) / text_index::block_ + 1;
+    occ = c + align8(4 * 257);
+    bwt = occ + 4 * 256 * blocks;
+    bytes = (flags & kHasFm) ? bwt + align8(n + 1) : c;
+  }
+  std::size_t text, sa, lcp, c, occ, bwt, blocks, bytes;
+};
+
+// FM-index和后缀数组一致: primary是后缀0所在的行, c从1开始递增到n+1,
+// occ的检查点等于bwt中实际的计数. 这样反向搜索得到的行号都不超过n+1
+bool check_fm(const unsigned char* data, const layout& lay, std::size_t n, std::uint64_t primary,
+              const std::int32_t* sa) {
+  if (n == 0 ? primary != 0 : primary == 0 || sa[primary - 1] != 0) return false;
+  auto c = reinterpret_cast<const std::uint32_t*>(data + lay.c);
+  auto occ = reinterpret_cast<const std::uint32_t*>(data + lay.occ);
+  auto bwt = data + lay.bwt;
+  if (c[0] != 1 || c[256] != n + 1) return false;
+  for (int ch = 0; ch < 256; ++ch)
+    if (c[ch] > c[ch + 1]) return false;
+  std::uint32_t cnt[256] = {0};
+  for (std::size_t r = 0; r <= n; ++r) {
+    if (r % text_index::block_ == 0 &&
+        !std::equal(cnt, cnt + 256, occ + r / text_index::block_ * 256))
+      return false;
+    if (r != primary) ++cnt[bwt[r]];
+  }
+  // 最后一个检查点可能在行n+1
+  if ((n + 1) % text_index::block_ == 0 && !std::equal(cnt, cnt + 256, occ + (lay.blocks - 1) * 256))
+    return false;
+  for (int ch = 0; ch < 256; ++ch)
+    if (cnt[ch] != c[ch + 1] - c[ch]) return false;
+  return true;
+}
+}  // namespace
+
+bool text_index::build(const char* text, std::size_t n, bool with_lcp, bool with_fm) {
+  clear();
+  if (n > static_cast<std::size_t>(INT32_MAX)) return false;
+  auto s = reinterpret_cast<const unsigned char*>(text);
+  std::uint64_t flags = (with_lcp ? kHasLcp : 0) | (with_fm ? kHasFm : 0);
+  layout lay(n, flags);
+  storage_.assign(lay.bytes / 8, 0);
+  auto base = reinterpret_cast<unsigned char*>(storage_.data());
+
+  auto sa = build_suffix_array(s, n);
+  header h;
+  std::memcpy(h.magic, kMagic, sizeof(kMagic));
+  h.n = n;
+  h.flags = flags;
+  h.primary = 0;
+  h.bytes = lay.bytes;
+  std::fill(std::begin(h.reserved), std::end(h.reserved), 0);
+  if (n > 0) {
+    std::memcpy(base + lay.text, s, n);
+    std::memcpy(base + lay.sa, sa.data(), 4 * n);
+  }
+  if (with_lcp && n > 0) {
+    auto lcp = build_lcp(s, n, sa);
+    std::memcpy(base + lay.lcp, lcp.data(), 4 * n);
+  }
+  if (with_fm) {
+    auto rows = n + 1;
+    auto bwt = base + lay.bwt;
+    auto c = reinterpret_cast<std::uint32_t*>(base + lay.c);
+    auto occ = reinterpret_cast<std::uint32_t*>(base + lay.occ);
+    // 行0是空后缀, 行r是后缀sa[r-1]
+    for (std::size_t r = 0; r < rows; ++r) {
+      std::size_t pos = r == 0 ? n : static_cast<std::size_t>(sa[r - 1]);
+      if (pos == 0)
+        h.primary = r;
+      else
+        bwt[r] = s[pos - 1];
+    }
+    std::uint32_t cnt[256] = {0};
+    for (std::size_t i = 0; i < n; ++i) ++cnt[s[i]];
+    c[0] = 1;
+    for (int ch = 0; ch < 256; ++ch) c[ch + 1] = c[ch] + cnt[ch];
+    std::fill(cnt, cnt + 256, 0);
+    for (std::size_t r = 0; r <= lay.blocks * block_ - block_; ++r) {
+      if (r % block_ == 0) std::copy(cnt, cnt + 256, occ + r / block_ * 256);
+      if (r < rows && r != h.primary) ++cnt[bwt[r]];
+    }
+  }
+  std::memcpy(base, &h, sizeof(h));
+  return attach(base, lay.bytes);
+}
+
+void text_index::clear() {
+  file_.close();
+  storage_.clear();
+  n_ = 0;
+  data_ = text_ = bwt_ = nullptr;
+  sa_ = lcp_ = nullptr;
+  c_ = occ_ = nullptr;
+  primary_ = 0;
+}
+
+bool text_index::attach(const unsigned char* data, std::size_t bytes) {
+  header h;
+  if (!read_header(data, bytes, kMagic, h) || h.n > INT32_MAX) return false;
+  layout lay(h.n, h.flags);
+  if (h.bytes != lay.bytes || bytes < lay.bytes || h.primary > h.n) return false;
+
+  // 文件可能损坏. 查询时会用后缀数组和FM-index的值做下标, 先检查它们不会越界
+  std::size_t n = h.n;
+  auto sa = reinterpret_cast<const std::int32_t*>(data + lay.sa);
+  for (std::size_t i = 0; i < n; ++i)
+    if (sa[i] < 0 || static_cast<std::size_t>(sa[i]) >= n) return false;
+  if ((h.flags & kHasFm) && !check_fm(data, lay, n, h.primary, sa)) return false;
+
+  data_ = data;
+  n_ = n;
+  text_ = data + lay.text;
+  sa_ = sa;
+  lcp_ = (h.flags & kHasLcp) ? reinterpret_cast<const std::int32_t*>(data + lay.lcp) : nullptr;
+  if (h.flags & kHasFm) {
+    c_ = reinterpret_cast<const std::uint32_t*>(data + lay.c);
+    occ_ = reinterpret_cast<const std::uint32_t*>(data + lay.occ);
+    bwt_ = data + lay.bwt;
+    primary_ = h.primary;
+  }
+  return true;
+}
+
+bool text_index::save(const std::string& path) const {
+  if (data_ == nullptr) return false;
+  header h;
+  std::memcpy(&h, data_, sizeof(h));
+  return write_file(path, data_, h.bytes);
+}
+
+bool text_index::load(const std::string& path) {
+  clear();
+  if (!file_.open(path, false) ||
+      !attach(reinterpret_cast<const unsigned char*>(file_.data()), file_.size())) {
+    clear();
+    return false;
+  }
+  return true;
+}
+
+std::pair<int, std::size_t> text_index::compare(std::size_t row, const unsigned char* p,
+                                                std::size_t m, std::size_t skip) const {
+  auto pos = static_cast<std::size_t>(sa_[row]);
+  auto i = skip;
+  while (i < m && pos + i < n_ && text_[pos + i] == p[i]) ++i;
+  if (i == m) return std::make_pair(0, i);
+  // 后缀是pattern的真前缀, 排在前面
+  if (pos + i == n_) return std::make_pair(-1, i);
+  return std::make_pair(text_[pos + i] < p[i] ? -1 : 1, i);
+}
+
+std::size_t text_index::bound(const unsigned char* p, std::size_t m, bool upper) const {
+  // 区间两端的行和pattern的公共前缀长度. 区间内的后缀至少有min(lcp_l, lcp_r)个字符相同
+  std::size_t l = 0, r = n_, lcp_l = 0, lcp_r = 0;
+  while (l < r) {
+    auto mid = l + (r - l) / 2;
+    auto res = compare(mid, p, m, std::min(lcp_l, lcp_r));
+    if (upper ? res.first <= 0 : res.first < 0) {
+      l = mid + 1;
+      lcp_l = res.second;
+    } else {
+      r = mid;
+      lcp_r = res.second;
+    }
+  }
+  return l;
+}
+
+std::size_t text_index::occ(unsigned char c, std::size_t i) const {
+  auto b = i / block_;
+  std::size_t cnt = occ_[b * 256 + c];
+  for (auto r = b * block_; r < i; ++r) cnt += bwt_[r] == c && r != primary_;
+  return cnt;
+}
+
+std::pair<std::size_t, std::size_t> text_index::range(const char* pattern, std::size_t m) const {
+  if (m == 0) return std::make_pair(std::size_t(0), n_);
+  auto p = reinterpret_cast<const unsigned char*>(pattern);
+  if (bwt_ != nullptr) {
+    // 反向搜索, 行号减1得到后缀数组的下标
+    std::size_t lo = 0, hi = n_ + 1;
+    for (auto k = m; k-- > 0 && lo < hi;) {
+      auto c = p[k];
+      lo = c_[c] + occ(c, lo);
+      hi = c_[c] + occ(c, hi);
+    }
+    if (lo >= hi) return std::make_pair(std::size_t(0), std::size_t(0));
+    return std::make_pair(lo - 1, hi - 1);
+  }
+  auto lo = bound(p, m, false);
+  return std::make_pair(lo, bound(p, m, true));
+}
+
+std::vector<std::size_t> text_index::locate(const char* pattern, std::size_t m) const {
+  auto r = range(pattern, m);
+  std::vector<std::size_t> ans(sa_ + r.first, sa_ + r.second);
+  std::sort(ans.begin(), ans.end());
+  return ans;
+}
+}  // namespace wzj
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <util/mapped_file.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace wzj {
+
+// 固定字节语料上的全文索引, 适合对同一份文本做大量查询.
+// 1. 后缀数组用SA-IS建立, 可选LCP数组(Kasai)和FM-index
+// 2. count/locate: 没有FM-index时在后缀数组上二分, O(m log n);
+//    有FM-index时反向搜索, O(m)次rank, 每次rank最多扫描block_个字节
+// 3. 所有数据放在一块连续内存中, save()原样写入文件, load()用mmap直接使用, 不需要反序列化.
+//    文件格式使用本机字节序, 只能在相同字节序的机器上加载
+// 文本长度不能超过INT32_MAX(后缀数组和rank表使用32位整数), 更长的文本build()返回false
+class text_index {
+ public:
+  // FM-index每隔block_行保存一次所有字符的rank
+  static constexpr std::size_t block_ = 256;
+
+ public:
+  text_index() {}
+  // 复制text并建立索引
+  text_index(const char* text, std::size_t n, bool with_lcp = true, bool with_fm = false) {
+    build(text, n, with_lcp, with_fm);
+  }
+  explicit text_index(const std::string& text, bool with_lcp = true, bool with_fm = false)
+      : text_index(text.data(), text.size(), with_lcp, with_fm) {}
+  ~text_index() { clear(); }
+  text_index(const text_index&) = delete;
+  text_index& operator=(const text_index&) = delete;
+
+  // 复制text并建立索引. n超过INT32_MAX时返回false, 索引为空
+  bool build(const char* text, std::size_t n, bool with_lcp = true, bool with_fm = false);
+  void clear();
+
+  // 写入文件. 失败返回false
+  bool save(const std::string& path) const;
+  // 映射save()生成的文件. 文件不存在或格式不对时返回false, 索引变为空.
+  // 加载时扫描一遍后缀数组和FM-index, 检查其中的下标不越界(O(n)), 损坏的文件也返回false
+  bool load(const std::string& path);
+
+  // 包含pattern的后缀在后缀数组中的区间[lo, hi)
+  std::pair<std::size_t, std::size_t> range(const char* pattern, std::size_t m) const;
+  std::pair<std::size_t, std::size_t> range(const std::string& pattern) const {
+    return range(pattern.data(), pattern.size());
+  }
+  // pattern出现的次数, 可以重叠
+  std::size_t count(const char* pattern, std::size_t m) const {
+    auto r = range(pattern, m);
+    return r.second - r.first;
+  }
+  std::size_t count(const std::string& pattern) const { return count(pattern.data(), pattern.size()); }
+  // pattern所有出现的起点, 从小到大
+  std::vector<std::size_t> locate(const char* pattern, std::size_t m) const;
+  std::vector<std::size_t> locate(const std::string& pattern) const {
+    return locate(pattern.data(), pattern.size());
+  }
+
+  std::size_t size() const { return n_; }
+  const char* text() const { return reinterpret_cast<const char*>(text_); }
+  const std::int32_t* suffix_array() const { return sa_; }
+  const std::int32_t* lcp() const { return lcp_; }  // 没有LCP数组时为nullptr
+  bool has_lcp() const { return lcp_ != nullptr; }
+  bool has_fm() const { return bwt_ != nullptr; }
+
+ private:
+  // 按照data中的布局设置各个数组的指针. 布局不合法或数组中的下标越界时返回false
+  bool attach(const unsigned char* data, std::size_t bytes);
+
+  // 后缀sa_[row]的前m个字符和pattern比较, 已知前skip个字符相同. 返回(比较结果, 公共前缀长度)
+  std::pair<int, std::size_t> compare(std::size_t row, const unsigned char* p, std::size_t m,
+                                      std::size_t skip) const;
+  // 第一个前m个字符>=p(upper==false)或>p(upper==true)的行
+  std::size_t bound(const unsigned char* p, std::size_t m, bool upper) const;
+  // bwt_[0, i)中c出现的次数
+  std::size_t occ(unsigned char c, std::size_t i) const;
+
+ private:
+  const unsigned char* data_ = nullptr;  // 文件头, 后面是各个数组
+  std::size_t n_ = 0;
+  const unsigned char* text_ = nullptr;
+  const std::int32_t* sa_ = nullptr;
+  const std::int32_t* lcp_ = nullptr;
+  // FM-index. 行0是空后缀, 行r(r>=1)是后缀sa_[r-1]. bwt_[r]是该后缀前面的字符.
+  // 后缀0前面没有字符, 它所在的行是primary_, 计算rank时跳过
+  const unsigned char* bwt_ = nullptr;
+  const std::uint32_t* c_ = nullptr;    // c_[c]: 小于c的后缀的行数, 257项
+  const std::uint32_t* occ_ = nullptr;  // occ_[b*256 + c]: bwt_[0, b*block_)中c出现的次数
+  std::size_t primary_ = 0;
+
+  // build()的数据, 按8字节对齐
+  std::vector<std::uint64_t> storage_;
+  // load()的映射
+  mapped_file file_;
+};
+}  // namespace wzj
@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <cmath>
+#include <cstring>
 
 #define ARRAY_NULL(x) \
   if (x) {            \
@@ -0,0 +1,92 @@
+#include <util/mapped_file.h>
+
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace wzj {
+
+#ifdef _WIN32
+bool mapped_file::open(const std::string& path, bool sequential) {
+  close();
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    return false;
+  }
+  file_ = file;
+  size_ = static_cast<std::size_t>(size.QuadPart);
+  is_open_ = true;
+  if (size_ == 0) return true;  // 不能映射长度为0的文件
+
+  mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping_ != nullptr)
+    data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+  if (data_ == nullptr) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+void mapped_file::close() {
+  if (data_) UnmapViewOfFile(data_);
+  if (mapping_) CloseHandle(mapping_);
+  if (file_) CloseHandle(file_);
+  data_ = nullptr;
+  mapping_ = file_ = nullptr;
+  size_ = 0;
+  is_open_ = false;
+}
+#else
+bool mapped_file::open(const std::string& path, bool sequential) {
+  close();
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    return false;
+  }
+  size_ = static_cast<std::size_t>(st.st_size);
+  if (size_ > 0) {
+    void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      ::close(fd);
+      size_ = 0;
+      return false;
+    }
+    madvise(p, size_, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+    data_ = static_cast<const char*>(p);
+  }
+  // 映射建立之后就不再需要fd
+  ::close(fd);
+  is_open_ = true;
+  return true;
+}
+
+void mapped_file::close() {
+  if (data_) munmap(const_cast<char*>(data_), size_);
+  data_ = nullptr;
+  size_ = 0;
+  is_open_ = false;
+}
+#endif
+
+bool write_file(const std::string& path, const void* data, std::size_t bytes) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+  return static_cast<bool>(out);
+}
+
+}  // namespace wzj
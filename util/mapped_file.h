@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace wzj {
+
+// 只读映射整个文件. 映射后提示内核的访问方式(madvise(MADV_SEQUENTIAL/MADV_RANDOM))
+// 直接在映射的内存上搜索或者使用索引, 不需要read()拷贝, 也不需要在内存中保留第二份
+class mapped_file {
+ public:
+  mapped_file() {}
+  explicit mapped_file(const std::string& path, bool sequential = true) { open(path, sequential); }
+  ~mapped_file() { close(); }
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  // 失败返回false. 空文件也算成功, 此时data()==nullptr.
+  // sequential==false表示随机访问(例如在索引上二分), 内核不做预读
+  bool open(const std::string& path, bool sequential = true);
+  void close();
+
+  bool is_open() const { return is_open_; }
+  const char* data() const { return data_; }
+  std::size_t size() const { return size_; }
+  const char* begin() const { return data_; }
+  const char* end() const { return data_ + size_; }
+
+ private:
+  const char* data_ = nullptr;
+  std::size_t size_ = 0;
+  bool is_open_ = false;
+#ifdef _WIN32
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#endif
+};
+
+// 索引文件的文件头以8字节的magic开头, 最后一个字节是格式版本.
+// data至少有sizeof(_Header)字节并且以magic开头时, 把文件头复制到h并返回true
+template <typename _Header>
+bool read_header(const void* data, std::size_t bytes, const char (&magic)[8], _Header& h) {
+  if (data == nullptr || bytes < sizeof(_Header)) return false;
+  std::memcpy(&h, data, sizeof(h));
+  return std::memcmp(h.magic, magic, sizeof(magic)) == 0;
+}
+
+// 把data[0, bytes)写入文件path, 覆盖原有内容. 失败返回false
+bool write_file(const std::string& path, const void* data, std::size_t bytes);
+}  // namespace wzj